@@ -1,7 +1,19 @@
 #ifndef _CACHEW_ALL_HPP
 #define _CACHEW_ALL_HPP
 
+#include "cachew/basic_cache.hpp"
 #include "cachew/lru_cache.hpp"
 #include "cachew/lfu_cache.hpp"
+#include "cachew/clock_cache.hpp"
+#include "cachew/slru_cache.hpp"
+#include "cachew/two_queue_cache.hpp"
+#include "cachew/arc_cache.hpp"
+#include "cachew/tinylfu_cache.hpp"
+#include "cachew/lirs_cache.hpp"
+#include "cachew/s3fifo_cache.hpp"
+#include "cachew/sieve_cache.hpp"
+#include "cachew/gdsf_cache.hpp"
+#include "cachew/flat_lfu_cache.hpp"
+#include "cachew/approx_lfu_cache.hpp"
 
 #endif //_CACHEW_ALL_HPP
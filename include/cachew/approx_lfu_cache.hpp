@@ -0,0 +1,459 @@
+#ifndef CACHEW_APPROX_LFU_CACHE_HPP
+#define CACHEW_APPROX_LFU_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cachew
+{
+
+// Approximate LFU cache. Every entry keeps an 8 bit logarithmic (Morris)
+// counter and the epoch it was last decayed in next to its value, there are
+// no per entry links. A hit increments the counter with a probability which
+// falls as the counter grows, so 255 stands for about a million hits. The
+// epoch advances every `decay_period` lookups and puts, and a counter loses
+// one for every epoch it was not hit in. Eviction samples `sample_size`
+// entries at random and evicts the one with the lowest counter.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class approx_lfu_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    static constexpr size_t  SAMPLE_SIZE = 5;
+    static constexpr uint8_t MAX_COUNTER = 255;
+    // New entries start above 0, so they are not the first to go.
+    static constexpr uint8_t INITIAL_COUNTER = 5;
+    // The larger it is, the slower the counters grow.
+    static constexpr unsigned LOG_FACTOR = 10;
+    // A shorter period forgets old hits sooner but loses the hit ratio of
+    // a steady workload.
+    static constexpr size_t DECAY_PERIOD_FACTOR = 100;
+
+    struct slot
+    {
+        std::optional<kv_pair> entry;
+        uint8_t                counter = 0;
+        uint16_t               epoch   = 0;
+    };
+
+    using lfu_slots = std::vector<slot>;
+    using lfu_map   = typename _Index::template map_type<key_type, slot *,
+                                                       hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename lfu_map::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second->entry->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second->entry->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const approx_lfu_cache &lhs,
+                            const approx_lfu_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // `decay_period` of 0 is `DECAY_PERIOD_FACTOR` times the capacity.
+    explicit approx_lfu_cache( size_t capacity,
+                               size_t sample_size  = SAMPLE_SIZE,
+                               size_t decay_period = 0 )
+        : _slots( capacity )
+        , _used( 0 )
+        , _capacity( capacity )
+        , _sample_size( std::max<size_t>( sample_size, 1 ) )
+        , _decay_period( decay_period > 0
+                             ? decay_period
+                             : std::max<size_t>( capacity, 1 ) *
+                                   DECAY_PERIOD_FACTOR )
+        , _ticks( 0 )
+        , _epoch( 0 )
+        , _random( 0x9e3779b97f4a7c15ULL )
+    {
+        // `release` must not allocate
+        _free.reserve( capacity );
+        _map.reserve( capacity );
+    }
+
+    approx_lfu_cache( const approx_lfu_cache &other )
+        : _slots( other._slots )
+        , _free( other._free )
+        , _used( other._used )
+        , _capacity( other._capacity )
+        , _sample_size( other._sample_size )
+        , _decay_period( other._decay_period )
+        , _ticks( other._ticks )
+        , _epoch( other._epoch )
+        , _random( other._random )
+    {
+        _free.reserve( _capacity );
+
+        // `_map` refers to the slots of `other` and has to be rebuilt
+        _map.reserve( _capacity );
+        for( auto &s : _slots )
+        {
+            if( s.entry )
+            {
+                _map.emplace( s.entry->first, &s );
+            }
+        }
+    }
+
+    // `other` is left as an empty cache of capacity 0.
+    approx_lfu_cache( approx_lfu_cache &&other )
+        : approx_lfu_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    approx_lfu_cache &operator=( const approx_lfu_cache &other )
+    {
+        if( this != &other )
+        {
+            approx_lfu_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    approx_lfu_cache &operator=( approx_lfu_cache &&other )
+    {
+        if( this != &other )
+        {
+            // `_map` refers to the slots, they keep their place in the moved
+            // vector
+            _slots        = std::move( other._slots );
+            _free         = std::move( other._free );
+            _map          = std::move( other._map );
+            _used         = std::exchange( other._used, 0 );
+            _capacity     = std::exchange( other._capacity, 0 );
+            _sample_size  = other._sample_size;
+            _decay_period = other._decay_period;
+            _ticks        = std::exchange( other._ticks, 0 );
+            _epoch        = std::exchange( other._epoch, 0 );
+            _random       = other._random;
+
+            other._slots.clear();
+            other._free.clear();
+            other._map.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( size_t i = 0; i < _used; ++i )
+        {
+            slot &s = _slots[i];
+            if( !s.entry )
+            {
+                continue;
+            }
+            const kv_pair &entry = *( s.entry );
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( s.entry->first );
+                release( s );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries, the epoch starts over.
+    void clear() noexcept
+    {
+        _map.clear();
+        for( size_t i = 0; i < _used; ++i )
+        {
+            _slots[i] = slot();
+        }
+        _free.clear();
+        _used  = 0;
+        _ticks = 0;
+        _epoch = 0;
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        tick();
+
+        auto it = _map.find( key );
+        if( it != _map.end() )
+        {
+            it->second->entry->second = std::forward<_PutT>( value );
+            touch( *( it->second ) );
+            return;
+        }
+        if( _capacity == 0 )
+        {
+            return;
+        }
+
+        slot &s = acquire();
+        try
+        {
+            s.entry.emplace( key, std::forward<_PutT>( value ) );
+            _map.emplace( key, &s );
+        }
+        catch( ... )
+        {
+            release( s );
+            throw;
+        }
+        s.counter = INITIAL_COUNTER;
+        s.epoch   = _epoch;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    size_t sample_size() const noexcept
+    {
+        return _sample_size;
+    }
+
+    size_t decay_period() const noexcept
+    {
+        return _decay_period;
+    }
+
+    // The decayed counter of `key`, 0 if it is not cached.
+    uint8_t counter( const key_type &key ) const
+    {
+        auto it = _map.find( key );
+        return it == _map.end() ? 0 : decayed( *( it->second ) );
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator( _map.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _map.end() );
+    }
+
+private:
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        tick();
+
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return end();
+        }
+        touch( *( it->second ) );
+
+        return iterator( it );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        slot &s = *( it->second );
+        _map.erase( it );
+        release( s );
+        return true;
+    }
+
+    void tick() noexcept
+    {
+        if( ++_ticks == _decay_period )
+        {
+            _ticks = 0;
+            ++_epoch;
+        }
+    }
+
+    // The epoch wraps around, a counter not touched for 65536 epochs or more
+    // decays less than it should. It is well below 255 by then anyway.
+    uint8_t decayed( const slot &s ) const noexcept
+    {
+        auto elapsed = static_cast<uint16_t>( _epoch - s.epoch );
+        return elapsed >= s.counter ? 0
+                                    : static_cast<uint8_t>( s.counter -
+                                                            elapsed );
+    }
+
+    void touch( slot &s ) noexcept
+    {
+        uint8_t counter = decayed( s );
+        if( counter < MAX_COUNTER )
+        {
+            unsigned base = counter > INITIAL_COUNTER
+                                ? counter - INITIAL_COUNTER
+                                : 0;
+            // with the probability of `1 / ( base * LOG_FACTOR + 1 )`
+            if( next_random() % ( base * LOG_FACTOR + 1 ) == 0 )
+            {
+                ++counter;
+            }
+        }
+        s.counter = counter;
+        s.epoch   = _epoch;
+    }
+
+    uint64_t next_random() noexcept
+    {
+        // xorshift64
+        _random ^= _random << 13;
+        _random ^= _random >> 7;
+        _random ^= _random << 17;
+        return _random;
+    }
+
+    // Returns an empty slot, evicting an entry if the cache is full.
+    slot &acquire()
+    {
+        if( !_free.empty() )
+        {
+            slot &s = _slots[_free.back()];
+            _free.pop_back();
+            return s;
+        }
+        if( _used < _capacity )
+        {
+            return _slots[_used++];
+        }
+
+        // every slot is used if none is free
+        slot   *victim  = nullptr;
+        uint8_t counter = 0;
+        for( size_t i = 0; i < _sample_size; ++i )
+        {
+            slot   &s = _slots[next_random() % _capacity];
+            uint8_t c = decayed( s );
+            if( victim == nullptr || c < counter )
+            {
+                victim  = &s;
+                counter = c;
+            }
+        }
+        _map.erase( victim->entry->first );
+        victim->entry.reset();
+        return *victim;
+    }
+
+    void release( slot &s ) noexcept
+    {
+        s = slot();
+        _free.push_back( static_cast<size_t>( &s - _slots.data() ) );
+    }
+
+    lfu_slots           _slots;
+    std::vector<size_t> _free;
+    lfu_map             _map;
+    size_t              _used;
+    size_t              _capacity;
+    size_t              _sample_size;
+    size_t              _decay_period;
+    size_t              _ticks;
+    uint16_t            _epoch;
+    uint64_t            _random;
+};
+
+// Approximate LFU eviction for `basic_cache`.
+struct approx_lfu_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = approx_lfu_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_APPROX_LFU_CACHE_HPP
@@ -0,0 +1,505 @@
+#ifndef CACHEW_ARC_CACHE_HPP
+#define CACHEW_ARC_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// Adaptive Replacement Cache. Resident entries are split between T1, keys
+// seen once recently, and T2, keys seen at least twice, both kept in LRU
+// order. The keys evicted from them are remembered by the B1 and B2 ghost
+// lists. A hit in B1 grows the target size of T1, a hit in B2 shrinks it, so
+// the cache moves between recency and frequency as the workload does.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class arc_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        bool is_frequent = false;
+    };
+
+    struct ghost
+    {
+        key_type key;
+        bool     is_frequent;
+    };
+
+    // T2 and T1 share one list, each from the most recently used entry. B2
+    // and B1 share another one in the same way.
+    using arc_list   = std::list<entry>;
+    using arc_map    = typename _Index::template map_type<
+        key_type, typename arc_list::iterator, hasher, key_equal>;
+    using ghost_list = std::list<ghost>;
+    using ghost_map  = typename _Index::template map_type<
+        key_type, typename ghost_list::iterator, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename arc_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const arc_cache &lhs, const arc_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    explicit arc_cache( size_t capacity )
+        : _t1( _list.end() )
+        , _b1( _ghosts.end() )
+        , _capacity( capacity )
+        , _target( 0 )
+        , _t1_size( 0 )
+        , _b1_size( 0 )
+    {
+    }
+
+    arc_cache( const arc_cache &other )
+        : _list( other._list )
+        , _t1( _list.end() )
+        , _ghosts( other._ghosts )
+        , _b1( _ghosts.end() )
+        , _capacity( other._capacity )
+        , _target( other._target )
+        , _t1_size( other._t1_size )
+        , _b1_size( other._b1_size )
+    {
+        // the maps and the list splits refer to the nodes of `other` and have
+        // to be rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+        }
+        _t1 = std::find_if( _list.begin(), _list.end(),
+                            []( const entry &e ) { return !e.is_frequent; } );
+
+        _ghost_map.reserve( _ghosts.size() );
+        for( auto it = _ghosts.begin(); it != _ghosts.end(); ++it )
+        {
+            _ghost_map.emplace( it->key, it );
+        }
+        _b1 = std::find_if( _ghosts.begin(), _ghosts.end(),
+                            []( const ghost &g ) { return !g.is_frequent; } );
+    }
+
+    arc_cache( arc_cache &&other )
+        : arc_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    arc_cache &operator=( const arc_cache &other )
+    {
+        if( this != &other )
+        {
+            arc_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    arc_cache &operator=( arc_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            bool t1_tail = other._t1 == other._list.end();
+            bool b1_tail = other._b1 == other._ghosts.end();
+            auto t1      = other._t1;
+            auto b1      = other._b1;
+
+            _list      = std::move( other._list );
+            _map       = std::move( other._map );
+            _t1        = t1_tail ? _list.end() : t1;
+            _ghosts    = std::move( other._ghosts );
+            _ghost_map = std::move( other._ghost_map );
+            _b1        = b1_tail ? _ghosts.end() : b1;
+            _capacity  = other._capacity;
+            _target    = other._target;
+            _t1_size   = other._t1_size;
+            _b1_size   = other._b1_size;
+
+            other.clear();
+        }
+        return *this;
+    }
+
+    // A hit moves the entry to the front of T2.
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    // Erased keys are not remembered by the ghost lists.
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries, forgets the ghost keys and the learned target.
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _ghost_map.clear();
+        _ghosts.clear();
+        _t1      = _list.end();
+        _b1      = _ghosts.end();
+        _target  = 0;
+        _t1_size = 0;
+        _b1_size = 0;
+    }
+
+    // An update is a hit. A key remembered by a ghost list adapts the target
+    // and goes to T2, any other new key goes to T1.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            it->second->second = std::forward<_PutT>( value );
+            promote( it->second );
+            return;
+        }
+
+        // the entry is made before anything is evicted for it
+        arc_list pending;
+        bool     frequent;
+        try
+        {
+            pending.emplace_back( key, std::forward<_PutT>( value ) );
+            frequent = admit( key );
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+
+        if( frequent )
+        {
+            pending.front().is_frequent = true;
+            _list.splice( _list.begin(), pending );
+            it->second = _list.begin();
+            return;
+        }
+        _list.splice( _t1, pending );
+        _t1        = std::prev( _t1 );
+        it->second = _t1;
+        ++_t1_size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    // Target size of T1, adapted by the ghost hits.
+    size_t target() const noexcept
+    {
+        return _target;
+    }
+
+    // Number of entries in T1.
+    size_t recent_size() const noexcept
+    {
+        return _t1_size;
+    }
+
+    // Number of keys in B1 and B2.
+    size_t ghost_size() const noexcept
+    {
+        return _ghosts.size();
+    }
+
+    // T2 entries go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    // Makes room for a new key, returns `true` if the key goes to T2.
+    bool admit( const key_type &key )
+    {
+        auto g = _ghost_map.find( key );
+        if( g != _ghost_map.end() )
+        {
+            // `replace` may rehash `_ghost_map`
+            auto   pos      = g->second;
+            bool   frequent = pos->is_frequent;
+            size_t b1       = std::max<size_t>( _b1_size, 1 );
+            size_t b2       = std::max<size_t>( _ghosts.size() - _b1_size, 1 );
+            if( frequent )
+            {
+                _target -= std::min( _target, std::max<size_t>( b1 / b2, 1 ) );
+            }
+            else
+            {
+                _target = std::min( _capacity,
+                                    _target + std::max<size_t>( b2 / b1, 1 ) );
+            }
+            replace( frequent );
+            forget( pos );
+            return true;
+        }
+
+        if( _t1_size + _b1_size >= _capacity )
+        {
+            if( _t1_size < _capacity && _b1_size > 0 )
+            {
+                forget( std::prev( _ghosts.end() ) );
+                replace( false );
+            }
+            else
+            {
+                auto victim = std::prev( _list.end() );
+                _map.erase( victim->first );
+                unlink( victim );
+            }
+        }
+        else if( _list.size() + _ghosts.size() >= _capacity )
+        {
+            if( _list.size() + _ghosts.size() >= 2 * _capacity &&
+                _b1 != _ghosts.begin() )
+            {
+                forget( std::prev( _b1 ) );
+            }
+            replace( false );
+        }
+        return false;
+    }
+
+    // Evicts the last entry of T1 to B1 if T1 is over the target, the last
+    // entry of T2 to B2 otherwise. `frequent` is set for a hit in B2.
+    void replace( bool frequent )
+    {
+        if( _list.size() < _capacity )
+        {
+            return;
+        }
+        bool from_t1 =
+            _t1_size > 0 && ( _t1_size > _target || _t1 == _list.begin() ||
+                              ( frequent && _t1_size == _target ) );
+
+        auto victim = from_t1 ? std::prev( _list.end() ) : std::prev( _t1 );
+        remember( victim->first, victim->is_frequent );
+        _map.erase( victim->first );
+        unlink( victim );
+    }
+
+    void remember( const key_type &key, bool frequent )
+    {
+        ghost_list pending;
+        pending.push_back( ghost{ key, frequent } );
+        // an evicted key is never in the ghost lists
+        auto g = _ghost_map.try_emplace( key ).first;
+        if( frequent )
+        {
+            _ghosts.splice( _ghosts.begin(), pending );
+            g->second = _ghosts.begin();
+            return;
+        }
+        _ghosts.splice( _b1, pending );
+        _b1       = std::prev( _b1 );
+        g->second = _b1;
+        ++_b1_size;
+    }
+
+    void forget( typename ghost_list::iterator pos )
+    {
+        if( pos == _b1 )
+        {
+            ++_b1;
+        }
+        if( !pos->is_frequent )
+        {
+            --_b1_size;
+        }
+        _ghost_map.erase( pos->key );
+        _ghosts.erase( pos );
+    }
+
+    // Moves a hit entry to the front of T2.
+    void promote( typename arc_list::iterator pos )
+    {
+        if( pos == _t1 )
+        {
+            ++_t1;
+        }
+        _list.splice( _list.begin(), _list, pos );
+        if( !pos->is_frequent )
+        {
+            pos->is_frequent = true;
+            --_t1_size;
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        promote( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename arc_list::iterator pos ) noexcept
+    {
+        if( pos == _t1 )
+        {
+            ++_t1;
+        }
+        if( !pos->is_frequent )
+        {
+            --_t1_size;
+        }
+        _list.erase( pos );
+    }
+
+    arc_list                      _list;
+    arc_map                       _map;
+    typename arc_list::iterator   _t1;
+    ghost_list                    _ghosts;
+    ghost_map                     _ghost_map;
+    typename ghost_list::iterator _b1;
+    size_t                        _capacity;
+    size_t                        _target;
+    size_t                        _t1_size;
+    size_t                        _b1_size;
+};
+
+// ARC eviction for `basic_cache`.
+struct arc_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = arc_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_ARC_CACHE_HPP
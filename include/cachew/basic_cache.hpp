@@ -0,0 +1,196 @@
+#ifndef CACHEW_BASIC_CACHE_HPP
+#define CACHEW_BASIC_CACHE_HPP
+
+#include "index.hpp"
+#include "storage.hpp"
+
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace cachew
+{
+
+// The cache is used from one thread at a time, `basic_cache` is the cache of
+// its eviction policy as is.
+struct no_sync
+{
+};
+
+// Every call takes one mutex. Iterators would not stay valid after the lock
+// is released, so lookups return copies of the values and the rest of the
+// cache interface is reached through `locked`.
+struct mutex_sync
+{
+};
+
+// A cache put together from compile time policies:
+//  - `_Eviction` names the cache which implements the eviction, it has
+//
+//      template <class _Key, class _Tp, class _Index, class _Storage,
+//                class _Hash, class _KeyEqual>
+//      using cache_type = ...;
+//
+//    and `storage_aware`, `false` if the entries are always kept in its own
+//    containers and `_Storage` must be `list_storage`. The policies are
+//    declared next to their caches, e.g. `lru_eviction`, `clock_eviction`.
+//  - `_Index` is the key index, `std_index` or `swiss_index`.
+//  - `_Storage` allocates the entries, `list_storage` or `slab_storage`.
+//  - `_Sync` is `no_sync` or `mutex_sync`.
+// All calls are resolved at compile time.
+template <class _Key, class _Tp, class _Eviction, class _Index = std_index,
+          class _Storage = list_storage, class _Sync = no_sync,
+          class _Hash     = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class basic_cache;
+
+template <class _Key, class _Tp, class _Eviction, class _Index, class _Storage,
+          class _Hash, class _KeyEqual>
+class basic_cache<_Key, _Tp, _Eviction, _Index, _Storage, no_sync, _Hash,
+                  _KeyEqual>
+    : public _Eviction::template cache_type<_Key, _Tp, _Index, _Storage,
+                                            _Hash, _KeyEqual>
+{
+    static_assert( _Eviction::storage_aware ||
+                       std::is_same_v<_Storage, list_storage>,
+                   "the eviction policy keeps its own entry storage" );
+
+public:
+    using eviction_policy = _Eviction;
+    using index_policy    = _Index;
+    using storage_policy  = _Storage;
+    using sync_policy     = no_sync;
+    using cache_type      = typename _Eviction::template cache_type<
+        _Key, _Tp, _Index, _Storage, _Hash, _KeyEqual>;
+
+    using cache_type::cache_type;
+};
+
+template <class _Key, class _Tp, class _Eviction, class _Index, class _Storage,
+          class _Hash, class _KeyEqual>
+class basic_cache<_Key, _Tp, _Eviction, _Index, _Storage, mutex_sync, _Hash,
+                  _KeyEqual>
+{
+    static_assert( _Eviction::storage_aware ||
+                       std::is_same_v<_Storage, list_storage>,
+                   "the eviction policy keeps its own entry storage" );
+
+public:
+    using eviction_policy = _Eviction;
+    using index_policy    = _Index;
+    using storage_policy  = _Storage;
+    using sync_policy     = mutex_sync;
+    using cache_type      = typename _Eviction::template cache_type<
+        _Key, _Tp, _Index, _Storage, _Hash, _KeyEqual>;
+
+    using key_type   = typename cache_type::key_type;
+    using value_type = typename cache_type::value_type;
+
+    // The arguments are the ones of `cache_type`.
+    template <class... _Args>
+    explicit basic_cache( size_t capacity, _Args &&... args )
+        : _cache( capacity, std::forward<_Args>( args )... )
+    {
+    }
+
+    basic_cache( const basic_cache &other )
+        : _cache( other.locked( []( const cache_type &c ) { return c; } ) )
+    {
+    }
+
+    basic_cache &operator=( const basic_cache &other )
+    {
+        if( this != &other )
+        {
+            cache_type tmp( other.locked(
+                []( const cache_type &c ) { return c; } ) );
+            std::lock_guard l{ _mutex };
+            _cache = std::move( tmp );
+        }
+        return *this;
+    }
+
+    template <class _K>
+    std::optional<value_type> get( const _K &key )
+    {
+        std::lock_guard l{ _mutex };
+
+        auto it = _cache.get( key );
+        if( it == _cache.end() )
+        {
+            return std::nullopt;
+        }
+        return *it;
+    }
+
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        std::lock_guard l{ _mutex };
+        _cache.put( key, std::forward<_PutT>( value ) );
+    }
+
+    template <class _K>
+    bool contains( const _K &key ) const
+    {
+        std::lock_guard l{ _mutex };
+        return _cache.contains( key );
+    }
+
+    template <class _K>
+    bool erase( const _K &key )
+    {
+        std::lock_guard l{ _mutex };
+        return _cache.erase( key );
+    }
+
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        std::lock_guard l{ _mutex };
+        return _cache.erase_if( std::move( pred ) );
+    }
+
+    void clear()
+    {
+        std::lock_guard l{ _mutex };
+        _cache.clear();
+    }
+
+    size_t capacity() const
+    {
+        std::lock_guard l{ _mutex };
+        return _cache.capacity();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard l{ _mutex };
+        return _cache.size();
+    }
+
+    // Calls `fn( cache )` under the lock, nothing `fn` gets from the cache
+    // may be kept after it returns.
+    template <class _Fn>
+    decltype( auto ) locked( _Fn &&fn )
+    {
+        std::lock_guard l{ _mutex };
+        return std::forward<_Fn>( fn )( _cache );
+    }
+
+    template <class _Fn>
+    decltype( auto ) locked( _Fn &&fn ) const
+    {
+        std::lock_guard l{ _mutex };
+        return std::forward<_Fn>( fn )( _cache );
+    }
+
+private:
+    cache_type         _cache;
+    mutable std::mutex _mutex;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_BASIC_CACHE_HPP
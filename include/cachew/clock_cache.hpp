@@ -0,0 +1,348 @@
+#ifndef CACHEW_CLOCK_CACHE_HPP
+#define CACHEW_CLOCK_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cachew
+{
+
+// CLOCK (second chance) cache. Entries live in a circular array, a hit only
+// sets the entry reference bit and eviction sweeps a hand over the array,
+// clearing the bits, until it finds an entry which was not referenced.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class clock_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct slot
+    {
+        std::optional<kv_pair> entry;
+        bool                   referenced = false;
+    };
+
+    using clock_slots = std::vector<slot>;
+    using clock_map   = typename _Index::template map_type<key_type, slot *,
+                                                         hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename clock_map::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second->entry->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second->entry->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const clock_cache &lhs, const clock_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    explicit clock_cache( size_t capacity )
+        : _slots( capacity )
+        , _hand( 0 )
+        , _used( 0 )
+        , _capacity( capacity )
+    {
+        // `release` must not allocate
+        _free.reserve( capacity );
+        _map.reserve( capacity );
+    }
+
+    clock_cache( const clock_cache &other )
+        : _slots( other._slots )
+        , _free( other._free )
+        , _hand( other._hand )
+        , _used( other._used )
+        , _capacity( other._capacity )
+    {
+        _free.reserve( _capacity );
+
+        // `_map` refers to the slots of `other` and has to be rebuilt
+        _map.reserve( _capacity );
+        for( auto &s : _slots )
+        {
+            if( s.entry )
+            {
+                _map.emplace( s.entry->first, &s );
+            }
+        }
+    }
+
+    // `other` is left as an empty cache of capacity 0.
+    clock_cache( clock_cache &&other )
+        : clock_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    clock_cache &operator=( const clock_cache &other )
+    {
+        if( this != &other )
+        {
+            clock_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    clock_cache &operator=( clock_cache &&other )
+    {
+        if( this != &other )
+        {
+            // `_map` refers to the slots, they keep their place in the moved
+            // vector
+            _slots    = std::move( other._slots );
+            _free     = std::move( other._free );
+            _map      = std::move( other._map );
+            _hand     = std::exchange( other._hand, 0 );
+            _used     = std::exchange( other._used, 0 );
+            _capacity = std::exchange( other._capacity, 0 );
+
+            other._slots.clear();
+            other._free.clear();
+            other._map.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( size_t i = 0; i < _used; ++i )
+        {
+            slot &s = _slots[i];
+            if( !s.entry )
+            {
+                continue;
+            }
+            const kv_pair &entry = *( s.entry );
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( s.entry->first );
+                release( s );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void clear() noexcept
+    {
+        _map.clear();
+        for( size_t i = 0; i < _used; ++i )
+        {
+            _slots[i].entry.reset();
+            _slots[i].referenced = false;
+        }
+        _free.clear();
+        _hand = 0;
+        _used = 0;
+    }
+
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        auto it = _map.find( key );
+        if( it != _map.end() )
+        {
+            it->second->entry->second = std::forward<_PutT>( value );
+            it->second->referenced    = true;
+            return;
+        }
+        if( _capacity == 0 )
+        {
+            return;
+        }
+
+        // an entry evicted for the slot is not restored on failure
+        slot &s = acquire();
+        try
+        {
+            s.entry.emplace( key, std::forward<_PutT>( value ) );
+            _map.emplace( key, &s );
+        }
+        catch( ... )
+        {
+            release( s );
+            throw;
+        }
+        s.referenced = false;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator( _map.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _map.end() );
+    }
+
+private:
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return end();
+        }
+        it->second->referenced = true;
+
+        return iterator( it );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        slot &s = *( it->second );
+        _map.erase( it );
+        release( s );
+        return true;
+    }
+
+    // Returns an empty slot, evicting an entry if the cache is full.
+    slot &acquire()
+    {
+        if( !_free.empty() )
+        {
+            slot &s = _slots[_free.back()];
+            _free.pop_back();
+            return s;
+        }
+        if( _used < _capacity )
+        {
+            return _slots[_used++];
+        }
+
+        for( ;; )
+        {
+            slot &s = _slots[_hand];
+            _hand   = ( _hand + 1 ) % _capacity;
+            if( !s.referenced )
+            {
+                _map.erase( s.entry->first );
+                s.entry.reset();
+                return s;
+            }
+            s.referenced = false;
+        }
+    }
+
+    void release( slot &s ) noexcept
+    {
+        s.entry.reset();
+        s.referenced = false;
+        _free.push_back( static_cast<size_t>( &s - _slots.data() ) );
+    }
+
+    clock_slots         _slots;
+    std::vector<size_t> _free;
+    clock_map           _map;
+    size_t              _hand;
+    size_t              _used;
+    size_t              _capacity;
+};
+
+// CLOCK eviction for `basic_cache`.
+struct clock_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = clock_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_CLOCK_CACHE_HPP
@@ -2,12 +2,20 @@
 #define CACHEW_CONCURRENT_CACHE_HPP
 
 #include "cache_iterator.hpp"
+#include "index.hpp"
+#include "promotion.hpp"
+#include "weigher.hpp"
 
 #include <algorithm>
 #include <atomic>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 
 namespace cachew
 {
@@ -41,36 +49,80 @@ public:
         key_type _key;
         node *   _prev;
         node *   _next;
+        // `_moves` of the list at the last move of the node to the front
+        std::atomic<uint64_t> _moved{ 0 };
     };
 
     inline void unlink( node *n )
     {
-        assert( _head != n );
+        assert( n->is_valid() );
 
-        node *prev  = n->_prev;
-        node *next  = n->_next;
-        prev->_next = next;
+        node *prev = n->_prev;
+        node *next = n->_next;
+        if( prev )
+        {
+            prev->_next = next;
+        }
+        else
+        {
+            _head = next;
+        }
         if( next )
         {
             next->_prev = prev;
         }
+        else
+        {
+            _tail = prev;
+        }
         n->_prev = node::OUT_OF_LIST_NODE;
+        n->_next = nullptr;
     }
 
     inline void move_front( node *n )
     {
-        assert( _head != n );
+        if( _head == n )
+        {
+            return;
+        }
+        if( n->is_valid() )
+        {
+            unlink( n );
+        }
 
-        n->_prev     = nullptr;
-        n->_next     = _head;
-        _head->_prev = n;
-        _head        = n;
+        n->_prev = nullptr;
+        n->_next = _head;
+        if( _head )
+        {
+            _head->_prev = n;
+        }
+        else
+        {
+            _tail = n;
+        }
+        _head = n;
+
+        uint64_t moves = _moves.load( std::memory_order_relaxed ) + 1;
+        _moves.store( moves, std::memory_order_relaxed );
+        n->_moved.store( moves, std::memory_order_relaxed );
+    }
+
+    // Returns the number of moves to the front since `n` was last moved
+    // there, it may be called without the list lock.
+    inline uint64_t age( const node *n ) const
+    {
+        uint64_t moves = _moves.load( std::memory_order_relaxed );
+        uint64_t moved = n->_moved.load( std::memory_order_relaxed );
+        return moves > moved ? moves - moved : 0;
     }
 
     inline node *pop_back()
     {
         node *to_remove = _tail;
-        unlink( _tail );
+        if( to_remove )
+        {
+            unlink( to_remove );
+        }
         return to_remove;
     }
 
@@ -79,93 +131,287 @@ public:
         return _tail;
     }
 
-    node *_head;
-    node *_tail;
+    node *_head = nullptr;
+    node *_tail = nullptr;
+
+    std::atomic<uint64_t> _moves{ 0 };
 };
 
 template <class key_type>
 typename list<key_type>::node *const
     list<key_type>::node::OUT_OF_LIST_NODE = (node *)-1;
 
-template <class Key, class Tp>
+// Entries are sharded over buckets with their own locks, while the recency
+// order is kept in one intrusive list. Lock order is always bucket, then
+// list; a node which is out of the list belongs to the thread evicting it.
+// The buckets are maps of `Index`. With `std_index` before C++20, a lookup
+// by another key type builds a temporary `key_type`, `swiss_index` looks it
+// up as it is.
+template <class Key, class Tp, class Hash = default_hash<Key>,
+          class KeyEqual = default_key_equal<Key>,
+          class Weigher  = unit_weigher,
+          class Index    = std_index>
 class concurrent_cache
 {
 public:
     using key_type   = Key;
     using value_type = Tp;
+    using hasher     = Hash;
+    using key_equal  = KeyEqual;
+    using weigher    = Weigher;
 
     using kv_pair = std::pair<key_type, value_type>;
 
-    using hash_fn   = std::hash<key_type>;
-    using conc_list = list<value_type>;
-    using node_ptr  = typename list<key_type>::node *;
+    using conc_list = list<key_type>;
+    using node_ptr  = typename conc_list::node *;
 
     using vi_pair = std::pair<value_type, node_ptr>;
 
 private:
+    template <class K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<K, key_type>>;
+
     class bucket
     {
-        using storage = std::unordered_map<key_type, vi_pair>;
+        using storage = typename Index::template map_type<key_type, vi_pair,
+                                                          hasher, key_equal>;
 
     public:
-        bucket()  = default;
+        // the total weight of all buckets is accounted in `weight`
+        bucket( const weigher &weigher_fn, size_t max_weight,
+                std::atomic<size_t> &weight, const promotion_policy &promotion )
+            : _weigher( weigher_fn )
+            , _max_weight( max_weight )
+            , _weight( weight )
+            , _promotion( promotion )
+        {
+        }
         ~bucket() = default;
 
-        bool find( const key_type &key )
+        template <class K>
+        bool find( const K &key )
         {
             std::shared_lock l{ _bucket_mutex };
 
-            return _map.find( key ) != _map.end();
+            return index_find<Index>( _map, key ) != _map.end();
         }
 
-        std::optional<vi_pair> get( const key_type &key )
+        template <class K>
+        std::optional<value_type> get( const K &key, conc_list &list,
+                                       std::mutex &list_mutex )
         {
             std::shared_lock l{ _bucket_mutex };
 
-            auto it = _map.find( key );
-            if( it != _map.end() )
+            auto it = index_find<Index>( _map, key );
+            if( it == _map.end() )
             {
-                return it->second;
+                return std::nullopt;
             }
 
-            return std::nullopt;
+            promote( it->second.second, list, list_mutex );
+
+            return it->second.first;
         }
 
-        node_ptr put( const key_type &key, vi_pair value )
+        // Returns the change of the entries count, an entry heavier than
+        // `max_weight` is removed instead of being stored.
+        template <class PutT>
+        int put( const key_type &key, PutT &&value, conc_list &list,
+                 std::mutex &list_mutex )
         {
-            std::shared_lock l{ _bucket_mutex };
-
-            node_ptr old_node = nullptr;
+            std::unique_lock l{ _bucket_mutex };
 
             auto it = _map.find( key );
-            if( it == _map.end() || it->second != value )
+            if( it != _map.end() )
             {
-                l.unlock();
-                l.lock();
-                it = _map.find( key );
+                size_t old_weight = _weigher( key, it->second.first );
+                it->second.first  = std::forward<PutT>( value );
+                size_t new_weight = _weigher( key, it->second.first );
+                _weight -= old_weight;
+                if( new_weight > _max_weight )
+                {
+                    node_ptr node = it->second.second;
+                    _map.erase( it );
+                    unlink( node, list, list_mutex );
+                    return -1;
+                }
+                _weight += new_weight;
 
-                if( it == _map.end() )
+                std::lock_guard ll{ list_mutex };
+                if( it->second.second->is_valid() )
                 {
-                    _map.emplace( key, std::move( value ) );
-                    // TODO: emplace may throw an exception
+                    list.move_front( it->second.second );
                 }
-                else if( it->second != value )
+                return 0;
+            }
+
+            using node = typename conc_list::node;
+
+            auto    new_node = std::make_unique<node>( key );
+            vi_pair entry( std::forward<PutT>( value ), new_node.get() );
+            size_t  weight = _weigher( key, entry.first );
+            if( weight > _max_weight )
+            {
+                return 0;
+            }
+            _map.emplace( key, std::move( entry ) );
+            _weight += weight;
+
+            std::lock_guard ll{ list_mutex };
+            list.move_front( new_node.release() );
+            return 1;
+        }
+
+        // Returns the value of `key` and the change of the entries count, a
+        // new entry is built from `args` only if there is no entry of `key`.
+        template <class... Args>
+        std::pair<value_type, int> emplace( const key_type &key,
+                                            conc_list &     list,
+                                            std::mutex &    list_mutex,
+                                            Args &&... args )
+        {
+            std::unique_lock l{ _bucket_mutex };
+
+            auto [it, inserted] =
+                _map.try_emplace( key, std::forward<Args>( args )... );
+            if( !inserted )
+            {
+                promote( it->second.second, list, list_mutex );
+                return { it->second.first, 0 };
+            }
+
+            using node = typename conc_list::node;
+
+            std::unique_ptr<node> new_node;
+            size_t                weight = 0;
+            try
+            {
+                new_node = std::make_unique<node>( key );
+                weight   = _weigher( key, it->second.first );
+            }
+            catch( ... )
+            {
+                _map.erase( it );
+                throw;
+            }
+            if( weight > _max_weight )
+            {
+                value_type value = std::move( it->second.first );
+                _map.erase( it );
+                return { std::move( value ), 0 };
+            }
+            it->second.second = new_node.get();
+            _weight += weight;
+
+            std::lock_guard ll{ list_mutex };
+            list.move_front( new_node.release() );
+            return { it->second.first, 1 };
+        }
+
+        // Returns `true` if the entry was removed.
+        template <class K>
+        bool remove( const K &key, conc_list &list, std::mutex &list_mutex )
+        {
+            std::unique_lock l{ _bucket_mutex };
+
+            auto it = index_find<Index>( _map, key );
+            if( it == _map.end() )
+            {
+                return false;
+            }
+
+            node_ptr node = it->second.second;
+            _weight -= _weigher( it->first, it->second.first );
+            _map.erase( it );
+            unlink( node, list, list_mutex );
+            return true;
+        }
+
+        void reserve( size_t count )
+        {
+            std::unique_lock l{ _bucket_mutex };
+            _map.reserve( count );
+        }
+
+        // Returns the number of removed entries.
+        template <class Pred>
+        size_t erase_if( Pred &pred, conc_list &list, std::mutex &list_mutex )
+        {
+            std::unique_lock l{ _bucket_mutex };
+
+            size_t removed = 0;
+            for( auto it = _map.begin(); it != _map.end(); )
+            {
+                const value_type &value = it->second.first;
+                if( !pred( it->first, value ) )
                 {
-                    old_node  = _map[key].second;
-                    _map[key] = std::move( value );
+                    ++it;
+                    continue;
                 }
+                node_ptr node = it->second.second;
+                _weight -= _weigher( it->first, value );
+                it = _map.erase( it );
+                unlink( node, list, list_mutex );
+                ++removed;
             }
-            return old_node;
+            return removed;
         }
 
-        void remove( const key_type &key )
+        // Removes the entry of an evicted node, returns `true` if the entry
+        // was still present.
+        bool remove_evicted( node_ptr node )
         {
-            std::shared_lock l{ _bucket_mutex };
+            std::unique_lock l{ _bucket_mutex };
+
+            auto it = _map.find( node->_key );
+            if( it == _map.end() || it->second.second != node )
+            {
+                return false;
+            }
+            _weight -= _weigher( it->first, it->second.first );
+            _map.erase( it );
+            return true;
         }
 
     private:
-        storage           _map;
-        std::shared_mutex _bucket_mutex;
+        // Moves the node of a hit to the front if `_promotion` lets it.
+        // Recency is best effort, a contended list is not waited for.
+        void promote( node_ptr node, conc_list &list, std::mutex &list_mutex )
+        {
+            if( !_promotion.promotes( list.age( node ) ) )
+            {
+                return;
+            }
+            std::unique_lock ll{ list_mutex, std::try_to_lock };
+            if( ll && node->is_valid() )
+            {
+                list.move_front( node );
+            }
+        }
+
+        // Unlinks and deletes the node of a removed entry.
+        static void unlink( node_ptr node, conc_list &list,
+                            std::mutex &list_mutex )
+        {
+            std::unique_lock ll{ list_mutex };
+            if( node->is_valid() )
+            {
+                list.unlink( node );
+                ll.unlock();
+                delete node;
+            }
+            // otherwise the node is being evicted and will be deleted by the
+            // evicting thread
+        }
+
+        storage                 _map;
+        std::shared_mutex       _bucket_mutex;
+        const weigher &         _weigher;
+        size_t                  _max_weight;
+        std::atomic<size_t> &   _weight;
+        const promotion_policy &_promotion;
     };
 
 public:
@@ -175,54 +421,146 @@ public:
         return !( rhs == lhs );
     }
 
-    explicit concurrent_cache( size_t capacity )
+    // Entries heavier than `max_weight` are not cached. The hits of `get`,
+    // `try_emplace` and `get_or_compute` move their entries to the front as
+    // `promotion` decides, a `put` always does.
+    explicit concurrent_cache( size_t           capacity,
+                               size_t           max_weight = UNLIMITED_WEIGHT,
+                               weigher          weigher_fn = weigher(),
+                               promotion_policy promotion  = {} )
         : _capacity( capacity )
-        , _buckets_count( std::thread::hardware_concurrency() )
+        , _buckets_count(
+              std::max( std::thread::hardware_concurrency(), 1U ) )
         , _size( 0 )
+        , _max_weight( max_weight )
+        , _weigher( std::move( weigher_fn ) )
+        , _weight( 0 )
+        , _promotion( promotion )
     {
         _buckets.reserve( _buckets_count );
         for( size_t i = 0; i < _buckets_count; ++i )
         {
-            _buckets.emplace_back( new bucket() );
+            _buckets.emplace_back(
+                new bucket( _weigher, _max_weight, _weight, _promotion ) );
+        }
+    }
+
+    ~concurrent_cache()
+    {
+        while( node_ptr node = _list.pop_back() )
+        {
+            delete node;
         }
     }
 
     std::optional<value_type> get( const key_type &key )
     {
-        bucket *bucket = find_bucket( key );
+        return find_bucket( key )->get( key, _list, _list_mutex );
+    }
+
+    template <class K, class = enable_if_heterogeneous<K>>
+    std::optional<value_type> get( const K &key )
+    {
+        return find_bucket( key )->get( key, _list, _list_mutex );
+    }
+
+    bool contains( const key_type &key )
+    {
+        return find_bucket( key )->find( key );
+    }
+
+    template <class K, class = enable_if_heterogeneous<K>>
+    bool contains( const K &key )
+    {
+        return find_bucket( key )->find( key );
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class K, class = enable_if_heterogeneous<K>>
+    bool erase( const K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries. Large caches are scanned by a thread per
+    // bucket, so `pred` may be called concurrently and must not throw.
+    // Entries which are added during the scan may be missed.
+    template <class Pred>
+    size_t erase_if( Pred pred )
+    {
+        std::atomic<size_t> removed{ 0 };
 
-        auto res = bucket->get( key );
+        size_t workers = _size < PARALLEL_ERASE_SIZE ? 1 : _buckets_count;
+        auto   work    = [this, &pred, &removed, workers]( size_t first ) {
+            for( size_t i = first; i < _buckets_count; i += workers )
+            {
+                size_t count =
+                    _buckets[i]->erase_if( pred, _list, _list_mutex );
+                _size -= count;
+                removed += count;
+            }
+        };
 
-        if( res )
+        std::vector<std::thread> threads;
+        try
         {
-            if( _list_mutex.try_lock() && ( *res ).second->is_valid() )
+            threads.reserve( workers - 1 );
+            for( size_t i = 1; i < workers; ++i )
             {
-                _list.move_front( ( *res ).second );
+                threads.emplace_back( work, i );
             }
         }
+        catch( ... )
+        {
+        }
+        // the shares of threads which failed to start are done here
+        for( size_t i = threads.size() + 1; i < workers; ++i )
+        {
+            work( i );
+        }
+        work( 0 );
+        for( auto &thread : threads )
+        {
+            thread.join();
+        }
+        return removed;
+    }
 
-        return !res ? std::nullopt
-                    : std::optional<key_type>( std::in_place, ( *res ).first );
+    void clear()
+    {
+        erase_if( []( const key_type &, const value_type & ) { return true; } );
     }
 
-    inline bucket *find_bucket( const key_type &key )
+    template <class K>
+    inline bucket *find_bucket( const K &key )
     {
-        size_t bucket_nr = hash_fn()( key ) % ( _buckets_count - 1 );
-        return _buckets[bucket_nr];
+        size_t bucket_nr = hash( key ) % _buckets_count;
+        return _buckets[bucket_nr].get();
     }
 
-    void evict()
+    // Returns `false` if there was nothing to evict.
+    bool evict()
     {
         std::unique_lock ll( _list_mutex );
         auto             to_evict = _list.pop_back();
         ll.unlock();
 
-        if( to_evict )
+        if( !to_evict )
         {
-            key_type key    = to_evict->_key;
-            bucket * bucket = find_bucket( key );
-            bucket->remove( key );
+            return false;
         }
+        bucket *bucket = find_bucket( to_evict->_key );
+        if( bucket->remove_evicted( to_evict ) )
+        {
+            _size--;
+        }
+        delete to_evict;
+        return true;
     }
 
     template <class PutT>
@@ -230,56 +568,146 @@ public:
     {
         bucket *bucket = find_bucket( key );
 
-        node_ptr new_node = new typename list<key_type>::node{ key };
-        node_ptr old_node =
-            bucket->put( key, std::make_pair( value, new_node ) );
-        // key, std::make_pair( std::forward( value ), new_node ) );
+        fit( bucket->put( key, std::forward<PutT>( value ), _list,
+                          _list_mutex ) );
+    }
 
-        size_t cur_size     = _size.load();
-        bool   size_changed = true;
-        if( cur_size >= _capacity &&
-            old_node == nullptr ) // if old_node == nullptr this is insertation,
-                                  // and storage size will growth.
-        {
-            evict();
-            size_changed = false;
-        }
+    // Returns the value of `key` and `true` if the entry was added, the value
+    // is built from `args` only if there was no entry. A new entry heavier
+    // than `max_weight` is returned, but not added.
+    template <class... Args>
+    std::pair<value_type, bool> try_emplace( const key_type &key,
+                                             Args &&... args )
+    {
+        auto res = find_bucket( key )->emplace(
+            key, _list, _list_mutex, std::piecewise_construct,
+            std::forward_as_tuple( std::forward<Args>( args )... ),
+            std::forward_as_tuple( nullptr ) );
+        fit( res.second );
+        return { std::move( res.first ), res.second > 0 };
+    }
 
-        {
-            std::unique_lock ll( _list_mutex );
+    // Returns the value of `key`, adding the result of `fn( key )` if there
+    // is no entry. `fn` runs under the lock of the key bucket, so a key is
+    // computed once by concurrent callers.
+    template <class Fn>
+    value_type get_or_compute( const key_type &key, Fn &&fn )
+    {
+        auto res = find_bucket( key )->emplace(
+            key, _list, _list_mutex, lazy_value<Fn>{ fn, key }, nullptr );
+        fit( res.second );
+        return std::move( res.first );
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return _capacity.load();
+    }
 
-            // updated node, we should remove old value
-            if( old_node != nullptr )
+    // The new capacity bounds the cache at once: while the cache is over it,
+    // a put never grows it and evicts up to `TRIM_BATCH` more entries. The
+    // buckets are reserved for a bigger capacity.
+    void resize( size_t capacity )
+    {
+        if( capacity > _capacity )
+        {
+            for( auto &bucket : _buckets )
             {
-                _list.unlink( old_node );
-                delete old_node;
+                bucket->reserve( capacity / _buckets_count + 1 );
             }
+        }
+        _capacity = capacity;
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size.load();
+    }
+
+    [[nodiscard]] size_t weight() const noexcept
+    {
+        return _weight.load();
+    }
+
+    [[nodiscard]] size_t max_weight() const noexcept
+    {
+        return _max_weight;
+    }
 
-            _list.move_front( new_node );
+    [[nodiscard]] const promotion_policy &promotion() const noexcept
+    {
+        return _promotion;
+    }
+
+private:
+    // smaller caches are scanned by the calling thread alone
+    static constexpr size_t PARALLEL_ERASE_SIZE = 1 << 14;
+    static constexpr size_t TRIM_BATCH          = 64;
+
+    // Converts to the result of `fn( key )`, so the value is computed only
+    // when it is emplaced.
+    template <class Fn>
+    struct lazy_value
+    {
+        operator value_type() const
+        {
+            return std::invoke( fn, key );
         }
-        if( size_changed )
+
+        Fn &            fn;
+        const key_type &key;
+    };
+
+    // Accounts `added` entries and evicts until the cache is within its
+    // bounds, the entries over the capacity left by `resize` are evicted in
+    // batches.
+    void fit( int added )
+    {
+        _size += added;
+
+        size_t budget = TRIM_BATCH + 1;
+        while( ( _weight > _max_weight ||
+                 ( _size > _capacity && budget-- > 0 ) ) &&
+               evict() )
         {
-            _size++;
         }
     }
 
-    [[nodiscard]] size_t capacity() const noexcept
+    template <class K>
+    size_t hash( const K &key ) const
     {
-        return _capacity;
+        if constexpr( std::is_same_v<K, key_type> ||
+                      is_transparent<hasher, key_equal>::value )
+        {
+            return hasher()( key );
+        }
+        else
+        {
+            return hasher()( key_type( key ) );
+        }
     }
 
-    [[nodiscard]] size_t size() const noexcept
+    template <class K>
+    bool erase_impl( const K &key )
     {
-        return _size.load();
+        if( find_bucket( key )->remove( key, _list, _list_mutex ) )
+        {
+            _size--;
+            return true;
+        }
+        return false;
     }
 
-private:
-    conc_list             _list;
-    std::shared_mutex     _list_mutex;
-    size_t                _capacity;
-    size_t                _buckets_count;
-    std::vector<bucket *> _buckets;
-    std::atomic<size_t>   _size;
+    conc_list                            _list;
+    std::mutex                           _list_mutex;
+    std::atomic<size_t>                  _capacity;
+    size_t                               _buckets_count;
+    std::vector<std::unique_ptr<bucket>> _buckets;
+    std::atomic<size_t>                  _size;
+    size_t                               _max_weight;
+    weigher                              _weigher;
+    std::atomic<size_t>                  _weight;
+    const promotion_policy               _promotion;
 };
 } // namespace cachew
 
@@ -0,0 +1,529 @@
+#ifndef CACHEW_FLAT_LFU_CACHE_HPP
+#define CACHEW_FLAT_LFU_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cachew
+{
+
+// LFU cache kept in two arrays allocated with the cache, one of entry slots
+// and one of frequency buckets. Buckets are linked by index from the lowest
+// frequency and every bucket links its entries from the most recent one, so
+// neither a hit nor an insert allocates. With `swiss_index` the index does
+// not allocate either once it is reserved. A bucket lives as long as it has
+// entries, so there are never more buckets than entries.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class flat_lfu_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    static constexpr size_t NIL = static_cast<size_t>( -1 );
+
+    // `next` links the free slots too.
+    struct slot
+    {
+        std::optional<kv_pair> entry;
+        size_t                 prev   = NIL;
+        size_t                 next   = NIL;
+        size_t                 bucket = NIL;
+    };
+
+    // `next` links the free buckets too.
+    struct bucket
+    {
+        size_t frequency = 0;
+        size_t head      = NIL;
+        size_t tail      = NIL;
+        size_t prev      = NIL;
+        size_t next      = NIL;
+    };
+
+    using lfu_slots   = std::vector<slot>;
+    using lfu_buckets = std::vector<bucket>;
+    using lfu_map     = typename _Index::template map_type<key_type, slot *,
+                                                         hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename lfu_map::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second->entry->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second->entry->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const flat_lfu_cache &lhs,
+                            const flat_lfu_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    explicit flat_lfu_cache( size_t capacity )
+        : _slots( capacity )
+        , _buckets( capacity )
+        , _free_slot( NIL )
+        , _free_bucket( NIL )
+        , _head( NIL )
+        , _used( 0 )
+        , _buckets_used( 0 )
+        , _capacity( capacity )
+    {
+        // a new entry is indexed before an old one is evicted
+        _map.reserve( capacity + 1 );
+    }
+
+    flat_lfu_cache( const flat_lfu_cache &other )
+        : _slots( other._slots )
+        , _buckets( other._buckets )
+        , _free_slot( other._free_slot )
+        , _free_bucket( other._free_bucket )
+        , _head( other._head )
+        , _used( other._used )
+        , _buckets_used( other._buckets_used )
+        , _capacity( other._capacity )
+    {
+        // `_map` refers to the slots of `other` and has to be rebuilt
+        _map.reserve( _capacity + 1 );
+        for( auto &s : _slots )
+        {
+            if( s.entry )
+            {
+                _map.emplace( s.entry->first, &s );
+            }
+        }
+    }
+
+    // `other` is left as an empty cache of capacity 0.
+    flat_lfu_cache( flat_lfu_cache &&other )
+        : flat_lfu_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    flat_lfu_cache &operator=( const flat_lfu_cache &other )
+    {
+        if( this != &other )
+        {
+            flat_lfu_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    flat_lfu_cache &operator=( flat_lfu_cache &&other )
+    {
+        if( this != &other )
+        {
+            // `_map` refers to the slots, they keep their place in the moved
+            // vector
+            _slots        = std::move( other._slots );
+            _buckets      = std::move( other._buckets );
+            _map          = std::move( other._map );
+            _free_slot    = std::exchange( other._free_slot, NIL );
+            _free_bucket  = std::exchange( other._free_bucket, NIL );
+            _head         = std::exchange( other._head, NIL );
+            _used         = std::exchange( other._used, 0 );
+            _buckets_used = std::exchange( other._buckets_used, 0 );
+            _capacity     = std::exchange( other._capacity, 0 );
+
+            other._slots.clear();
+            other._buckets.clear();
+            other._map.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( size_t i = 0; i < _used; ++i )
+        {
+            slot &s = _slots[i];
+            if( !s.entry )
+            {
+                continue;
+            }
+            const kv_pair &entry = *( s.entry );
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( s.entry->first );
+                unlink( i );
+                release( i );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void clear() noexcept
+    {
+        _map.clear();
+        for( size_t i = 0; i < _used; ++i )
+        {
+            _slots[i] = slot();
+        }
+        _free_slot    = NIL;
+        _free_bucket  = NIL;
+        _head         = NIL;
+        _used         = 0;
+        _buckets_used = 0;
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key, nullptr );
+        if( !inserted )
+        {
+            it->second->entry->second = std::forward<_PutT>( value );
+            touch( index_of( *( it->second ) ) );
+            return;
+        }
+
+        if( _map.size() > _capacity )
+        {
+            evict();
+        }
+        size_t pos = acquire();
+        try
+        {
+            _slots[pos].entry.emplace( key, std::forward<_PutT>( value ) );
+        }
+        catch( ... )
+        {
+            release( pos );
+            _map.erase( it );
+            throw;
+        }
+        link_new( pos );
+        it->second = &_slots[pos];
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    // Number of frequency buckets in use.
+    size_t bucket_count() const noexcept
+    {
+        size_t count = 0;
+        for( size_t b = _head; b != NIL; b = _buckets[b].next )
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator( _map.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _map.end() );
+    }
+
+private:
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return end();
+        }
+        touch( index_of( *( it->second ) ) );
+
+        return iterator( it );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        size_t pos = index_of( *( it->second ) );
+        _map.erase( it );
+        unlink( pos );
+        release( pos );
+        return true;
+    }
+
+    size_t index_of( const slot &s ) const noexcept
+    {
+        return static_cast<size_t>( &s - _slots.data() );
+    }
+
+    // Moves the entry to the bucket of the next frequency. A bucket left
+    // with this entry only is relabeled instead.
+    void touch( size_t pos ) noexcept
+    {
+        size_t  b         = _slots[pos].bucket;
+        bucket &cur       = _buckets[b];
+        size_t  frequency = cur.frequency + 1;
+        size_t  next      = cur.next;
+
+        if( next != NIL && _buckets[next].frequency == frequency )
+        {
+            unlink( pos );
+            push_front( next, pos );
+        }
+        else if( cur.head == cur.tail )
+        {
+            cur.frequency = frequency;
+        }
+        else
+        {
+            size_t nb = make_bucket( frequency, b, next );
+            unlink( pos );
+            push_front( nb, pos );
+        }
+    }
+
+    // Links a new entry to the bucket of frequency 1.
+    void link_new( size_t pos ) noexcept
+    {
+        size_t b = _head;
+        if( b == NIL || _buckets[b].frequency != 1 )
+        {
+            b = make_bucket( 1, NIL, _head );
+        }
+        push_front( b, pos );
+    }
+
+    // Evicts the oldest entry of the lowest frequency.
+    void evict() noexcept
+    {
+        size_t pos = _buckets[_head].tail;
+        _map.erase( _slots[pos].entry->first );
+        unlink( pos );
+        release( pos );
+    }
+
+    size_t acquire() noexcept
+    {
+        if( _free_slot != NIL )
+        {
+            size_t pos = _free_slot;
+            _free_slot = _slots[pos].next;
+            return pos;
+        }
+        return _used++;
+    }
+
+    void release( size_t pos ) noexcept
+    {
+        slot &s = _slots[pos];
+        s.entry.reset();
+        s.prev     = NIL;
+        s.bucket   = NIL;
+        s.next     = _free_slot;
+        _free_slot = pos;
+    }
+
+    void push_front( size_t b, size_t pos ) noexcept
+    {
+        bucket &bk = _buckets[b];
+        slot   &s  = _slots[pos];
+        s.bucket   = b;
+        s.prev     = NIL;
+        s.next     = bk.head;
+        if( bk.head != NIL )
+        {
+            _slots[bk.head].prev = pos;
+        }
+        else
+        {
+            bk.tail = pos;
+        }
+        bk.head = pos;
+    }
+
+    // Takes the entry out of its bucket, a bucket left empty is freed.
+    void unlink( size_t pos ) noexcept
+    {
+        slot   &s  = _slots[pos];
+        size_t  b  = s.bucket;
+        bucket &bk = _buckets[b];
+        if( s.prev != NIL )
+        {
+            _slots[s.prev].next = s.next;
+        }
+        else
+        {
+            bk.head = s.next;
+        }
+        if( s.next != NIL )
+        {
+            _slots[s.next].prev = s.prev;
+        }
+        else
+        {
+            bk.tail = s.prev;
+        }
+        s.bucket = NIL;
+        if( bk.head == NIL )
+        {
+            free_bucket( b );
+        }
+    }
+
+    // Links a new bucket between `prev` and `next`.
+    size_t make_bucket( size_t frequency, size_t prev, size_t next ) noexcept
+    {
+        size_t b;
+        if( _free_bucket != NIL )
+        {
+            b            = _free_bucket;
+            _free_bucket = _buckets[b].next;
+        }
+        else
+        {
+            b = _buckets_used++;
+        }
+        _buckets[b] = bucket{frequency, NIL, NIL, prev, next};
+        if( prev != NIL )
+        {
+            _buckets[prev].next = b;
+        }
+        else
+        {
+            _head = b;
+        }
+        if( next != NIL )
+        {
+            _buckets[next].prev = b;
+        }
+        return b;
+    }
+
+    void free_bucket( size_t b ) noexcept
+    {
+        bucket &bk = _buckets[b];
+        if( bk.prev != NIL )
+        {
+            _buckets[bk.prev].next = bk.next;
+        }
+        else
+        {
+            _head = bk.next;
+        }
+        if( bk.next != NIL )
+        {
+            _buckets[bk.next].prev = bk.prev;
+        }
+        bk           = bucket();
+        bk.next      = _free_bucket;
+        _free_bucket = b;
+    }
+
+    lfu_slots   _slots;
+    lfu_buckets _buckets;
+    lfu_map     _map;
+    size_t      _free_slot;
+    size_t      _free_bucket;
+    size_t      _head;
+    size_t      _used;
+    size_t      _buckets_used;
+    size_t      _capacity;
+};
+
+// Flat LFU eviction for `basic_cache`.
+struct flat_lfu_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = flat_lfu_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_FLAT_LFU_CACHE_HPP
@@ -0,0 +1,191 @@
+#ifndef CACHEW_FREQUENCY_SKETCH_HPP
+#define CACHEW_FREQUENCY_SKETCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace cachew
+{
+
+// Approximate access frequencies of key hashes for TinyLFU admission. A
+// count-min sketch of 4 rows of 4-bit counters, 16 to a word, counts all
+// but the first access of a key, the first one only sets the bits of a
+// Bloom filter doorkeeper, so keys seen once take no counters. Every 10
+// accesses per entry of capacity all counters are halved and the doorkeeper
+// is cleared, so the frequencies follow a changing workload. With the
+// capacity rounded up to a power of two it takes 3 bytes per entry.
+class frequency_sketch
+{
+    static constexpr std::size_t   DEPTH         = 4;
+    static constexpr std::size_t   COUNTER_BITS  = 4;
+    static constexpr std::size_t   WORD_COUNTERS = 64 / COUNTER_BITS;
+    static constexpr std::uint64_t MAX_COUNT     = 15;
+    static constexpr std::size_t   SAMPLE_RATIO  = 10;
+
+    // the high bit of every counter cleared
+    static constexpr std::uint64_t HALF_MASK = 0x7777777777777777ULL;
+
+public:
+    // Frequencies stop growing at this value.
+    static constexpr unsigned MAX_FREQUENCY = MAX_COUNT + 1;
+
+    explicit frequency_sketch( std::size_t capacity )
+        : _width( width_for( capacity ) )
+        , _table( DEPTH * _width / WORD_COUNTERS )
+        , _doorkeeper( _width / 8 )
+        , _sample_size( SAMPLE_RATIO * std::max<std::size_t>( capacity, 1 ) )
+        , _additions( 0 )
+    {
+    }
+
+    // Counts an access of the key with `hash`.
+    void increment( std::size_t hash ) noexcept
+    {
+        std::uint64_t h = mix( hash );
+        if( ++_additions >= _sample_size )
+        {
+            halve();
+        }
+        if( !test_and_set( h ) )
+        {
+            return;
+        }
+        for( std::size_t row = 0; row < DEPTH; ++row )
+        {
+            std::uint64_t &word  = _table[word_index( h, row )];
+            unsigned       shift = counter_shift( h, row );
+            if( ( ( word >> shift ) & MAX_COUNT ) < MAX_COUNT )
+            {
+                word += std::uint64_t( 1 ) << shift;
+            }
+        }
+    }
+
+    // Estimated number of accesses of the key with `hash`, never less than
+    // the real one since the last halving.
+    unsigned frequency( std::size_t hash ) const noexcept
+    {
+        std::uint64_t h     = mix( hash );
+        std::uint64_t count = MAX_COUNT;
+        for( std::size_t row = 0; row < DEPTH; ++row )
+        {
+            std::uint64_t word = _table[word_index( h, row )];
+            count = std::min( count, ( word >> counter_shift( h, row ) ) &
+                                         MAX_COUNT );
+        }
+        return static_cast<unsigned>( count ) + ( test( h ) ? 1 : 0 );
+    }
+
+    void clear() noexcept
+    {
+        std::fill( _table.begin(), _table.end(), 0 );
+        std::fill( _doorkeeper.begin(), _doorkeeper.end(), 0 );
+        _additions = 0;
+    }
+
+    // Bytes taken by the counters and the doorkeeper.
+    std::size_t memory_size() const noexcept
+    {
+        return _table.size() * sizeof( std::uint64_t ) +
+               _doorkeeper.size() * sizeof( std::uint64_t );
+    }
+
+private:
+    // Counters per row, a power of two and a whole number of words.
+    static std::size_t width_for( std::size_t capacity ) noexcept
+    {
+        std::size_t width = 64;
+        while( width < capacity )
+        {
+            width <<= 1U;
+        }
+        return width;
+    }
+
+    static std::uint64_t mix( std::size_t hash ) noexcept
+    {
+        auto h = static_cast<std::uint64_t>( hash );
+        h ^= h >> 33U;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33U;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33U;
+        return h;
+    }
+
+    // Index of the counter of `h` in `row`, by double hashing.
+    std::size_t counter_index( std::uint64_t h, std::size_t row ) const
+    {
+        std::uint64_t step = ( h >> 32U ) | 1U;
+        return static_cast<std::size_t>( ( h + row * step ) & ( _width - 1 ) );
+    }
+
+    std::size_t word_index( std::uint64_t h, std::size_t row ) const
+    {
+        return ( row * _width + counter_index( h, row ) ) / WORD_COUNTERS;
+    }
+
+    unsigned counter_shift( std::uint64_t h, std::size_t row ) const
+    {
+        return static_cast<unsigned>( counter_index( h, row ) %
+                                      WORD_COUNTERS * COUNTER_BITS );
+    }
+
+    // The doorkeeper sets two bits per key. They are taken from `h` mixed
+    // again, as the counters index with the low and the high bits of `h`.
+    std::uint64_t doorkeeper_bit( std::uint64_t h, unsigned n ) const
+    {
+        std::uint64_t d = mix( static_cast<std::size_t>( h ) );
+        return ( d >> ( 32U * n ) ) & ( _doorkeeper.size() * 64 - 1 );
+    }
+
+    bool test( std::uint64_t h ) const noexcept
+    {
+        for( unsigned n = 0; n < 2; ++n )
+        {
+            std::uint64_t bit  = doorkeeper_bit( h, n );
+            std::uint64_t mask = std::uint64_t( 1 ) << bit % 64;
+            if( ( _doorkeeper[bit / 64] & mask ) == 0 )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Sets the doorkeeper bits, returns `true` if all of them were set.
+    bool test_and_set( std::uint64_t h ) noexcept
+    {
+        bool seen = true;
+        for( unsigned n = 0; n < 2; ++n )
+        {
+            std::uint64_t  bit  = doorkeeper_bit( h, n );
+            std::uint64_t  mask = std::uint64_t( 1 ) << bit % 64;
+            std::uint64_t &word = _doorkeeper[bit / 64];
+            seen                = seen && ( word & mask ) != 0;
+            word |= mask;
+        }
+        return seen;
+    }
+
+    void halve() noexcept
+    {
+        for( auto &word : _table )
+        {
+            word = ( word >> 1U ) & HALF_MASK;
+        }
+        std::fill( _doorkeeper.begin(), _doorkeeper.end(), 0 );
+        _additions /= 2;
+    }
+
+    std::size_t                _width;
+    std::vector<std::uint64_t> _table;
+    std::vector<std::uint64_t> _doorkeeper;
+    std::size_t                _sample_size;
+    std::size_t                _additions;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_FREQUENCY_SKETCH_HPP
@@ -0,0 +1,436 @@
+#ifndef CACHEW_GDSF_CACHE_HPP
+#define CACHEW_GDSF_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+#include "weigher.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace cachew
+{
+
+// Cost of fetching every entry is 1, the priority of an entry is then its
+// frequency divided by its weight.
+struct unit_cost
+{
+    template <class _Key, class _Tp>
+    constexpr double operator()( const _Key & /*key*/,
+                                 const _Tp & /*value*/ ) const noexcept
+    {
+        return 1.0;
+    }
+};
+
+// Greedy-Dual-Size-Frequency cache, the size aware variant of `lfu_cache`.
+// An entry has the priority `L + frequency * cost / weight` and the entry of
+// the lowest priority is evicted, so of two entries used as often the one
+// which is cheaper to fetch again per unit of weight goes first. `L`, the
+// inflation clock, rises to the priority of every evicted entry and new or
+// hit entries start from it, so entries which are no longer hit fall behind
+// and are evicted even with a high frequency. The cost functor returns the
+// cost of an entry as a positive `double`, like a weigher it must return the
+// same result for the same entry every time. A weight of 0 counts as 1.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash     = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>,
+          class _Weigher  = unit_weigher,
+          class _Coster   = unit_cost>
+class gdsf_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+    using weigher    = _Weigher;
+    using coster     = _Coster;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        size_t frequency = 1;
+        size_t weight    = 0;
+        double cost      = 0;
+    };
+
+    // Entries by priority, the equal ones from the least recently updated.
+    using gdsf_queue = std::multimap<double, entry>;
+    using gdsf_map   = typename _Index::template map_type<
+        key_type, typename gdsf_queue::iterator, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename gdsf_queue::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second.second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second.second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const gdsf_cache &lhs, const gdsf_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // Entries heavier than `max_weight` are not cached.
+    explicit gdsf_cache( size_t capacity, size_t max_weight = UNLIMITED_WEIGHT,
+                         weigher weigher_fn = weigher(),
+                         coster  coster_fn  = coster() )
+        : _capacity( capacity )
+        , _weight( 0 )
+        , _max_weight( max_weight )
+        , _inflation( 0 )
+        , _weigher( std::move( weigher_fn ) )
+        , _coster( std::move( coster_fn ) )
+    {
+    }
+
+    gdsf_cache( const gdsf_cache &other )
+        : _queue( other._queue )
+        , _capacity( other._capacity )
+        , _weight( other._weight )
+        , _max_weight( other._max_weight )
+        , _inflation( other._inflation )
+        , _weigher( other._weigher )
+        , _coster( other._coster )
+    {
+        // `_map` refers to the nodes of `other` and has to be rebuilt
+        _map.reserve( _queue.size() );
+        for( auto it = _queue.begin(); it != _queue.end(); ++it )
+        {
+            _map.emplace( it->second.first, it );
+        }
+    }
+
+    gdsf_cache( gdsf_cache &&other )
+        : gdsf_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    gdsf_cache &operator=( const gdsf_cache &other )
+    {
+        if( this != &other )
+        {
+            gdsf_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    // `other` is left empty and keeps its capacity.
+    gdsf_cache &operator=( gdsf_cache &&other )
+    {
+        if( this != &other )
+        {
+            _queue      = std::move( other._queue );
+            _map        = std::move( other._map );
+            _capacity   = other._capacity;
+            _weight     = std::exchange( other._weight, 0 );
+            _max_weight = other._max_weight;
+            _inflation  = std::exchange( other._inflation, 0 );
+            _weigher    = std::move( other._weigher );
+            _coster     = std::move( other._coster );
+
+            other._queue.clear();
+            other._map.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _queue.begin(); it != _queue.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = pos->second;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->second.first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries and resets the inflation clock.
+    void clear() noexcept
+    {
+        _map.clear();
+        _queue.clear();
+        _weight    = 0;
+        _inflation = 0;
+    }
+
+    // An update is a hit, the entry is weighed and costed again.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            update_at( it, std::forward<_PutT>( value ) );
+            return;
+        }
+
+        // the entry is made and weighed before anything is evicted for it,
+        // so eviction never picks it
+        gdsf_queue pending;
+        try
+        {
+            auto pos = pending.emplace(
+                0.0, entry( key, std::forward<_PutT>( value ) ) );
+            entry &e = pos->second;
+            e.weight = _weigher( e.first, e.second );
+            e.cost   = _coster( e.first, e.second );
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        auto   node   = pending.extract( pending.begin() );
+        size_t weight = node.mapped().weight;
+        if( weight > _max_weight )
+        {
+            _map.erase( it );
+            return;
+        }
+
+        if( _map.size() > _capacity )
+        {
+            evict();
+        }
+        while( weight > _max_weight - _weight )
+        {
+            evict();
+        }
+        _weight += weight;
+        node.key() = priority( node.mapped() );
+        it->second = _queue.insert( std::move( node ) );
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    size_t weight() const noexcept
+    {
+        return _weight;
+    }
+
+    size_t max_weight() const noexcept
+    {
+        return _max_weight;
+    }
+
+    // The inflation clock, the priority of the last evicted entry.
+    double inflation() const noexcept
+    {
+        return _inflation;
+    }
+
+    // Entries of a lower priority go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _queue.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _queue.end() );
+    }
+
+private:
+    double priority( const entry &e ) const noexcept
+    {
+        auto frequency = static_cast<double>( e.frequency );
+        auto weight = static_cast<double>( std::max<size_t>( e.weight, 1 ) );
+        return _inflation + frequency * e.cost / weight;
+    }
+
+    // Counts a hit, the entry moves to its new priority. Nodes are moved, so
+    // it never allocates.
+    typename gdsf_queue::iterator touch( typename gdsf_queue::iterator pos )
+    {
+        auto node = _queue.extract( pos );
+        ++node.mapped().frequency;
+        node.key() = priority( node.mapped() );
+        return _queue.insert( std::move( node ) );
+    }
+
+    template <class _PutT>
+    void update_at( typename gdsf_map::iterator it, _PutT &&value )
+    {
+        entry &e = it->second->second;
+        e.second = std::forward<_PutT>( value );
+
+        size_t weight = _weigher( e.first, e.second );
+        double cost   = _coster( e.first, e.second );
+        if( weight > _max_weight )
+        {
+            unlink( it->second );
+            _map.erase( it );
+            return;
+        }
+        _weight += weight - e.weight;
+        e.weight   = weight;
+        e.cost     = cost;
+        it->second = touch( it->second );
+        auto pos   = it->second;
+        while( _weight > _max_weight )
+        {
+            // the updated entry may be evicted too
+            bool last = _queue.begin() == pos;
+            evict();
+            if( last )
+            {
+                return;
+            }
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return end();
+        }
+        it->second = touch( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Evicts the entry of the lowest priority, the inflation clock rises to
+    // its priority.
+    void evict()
+    {
+        auto victim = _queue.begin();
+        _inflation  = std::max( _inflation, victim->first );
+        _map.erase( victim->second.first );
+        unlink( victim );
+    }
+
+    // Removes the entry from `_queue` only.
+    void unlink( typename gdsf_queue::iterator pos ) noexcept
+    {
+        _weight -= pos->second.weight;
+        _queue.erase( pos );
+    }
+
+    gdsf_queue _queue;
+    gdsf_map   _map;
+    size_t     _capacity;
+    size_t     _weight;
+    size_t     _max_weight;
+    double     _inflation;
+    weigher    _weigher;
+    coster     _coster;
+};
+
+// GDSF eviction for `basic_cache`.
+template <class _Weigher = unit_weigher, class _Coster = unit_cost>
+struct gdsf_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type =
+        gdsf_cache<_Key, _Tp, _Index, _Hash, _KeyEqual, _Weigher, _Coster>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_GDSF_CACHE_HPP
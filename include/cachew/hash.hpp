@@ -0,0 +1,59 @@
+#ifndef CACHEW_HASH_HPP
+#define CACHEW_HASH_HPP
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace cachew
+{
+
+// Default hash of the caches, it is transparent for string keys, so they
+// can be looked up by `std::string_view` or a string literal.
+template <class _Key>
+struct default_hash : std::hash<_Key>
+{
+};
+
+template <class _CharT, class _Traits, class _Alloc>
+struct default_hash<std::basic_string<_CharT, _Traits, _Alloc>>
+{
+    using is_transparent = void;
+
+    // std::hash of a string and of its string_view are the same
+    std::size_t
+    operator()( std::basic_string_view<_CharT, _Traits> key ) const noexcept
+    {
+        return std::hash<std::basic_string_view<_CharT, _Traits>>()( key );
+    }
+};
+
+template <class _Key>
+struct default_key_equal : std::equal_to<_Key>
+{
+};
+
+template <class _CharT, class _Traits, class _Alloc>
+struct default_key_equal<std::basic_string<_CharT, _Traits, _Alloc>>
+    : std::equal_to<>
+{
+};
+
+// `true` if both functors accept keys of any comparable type.
+template <class _Hash, class _KeyEqual, class = void>
+struct is_transparent : std::false_type
+{
+};
+
+template <class _Hash, class _KeyEqual>
+struct is_transparent<_Hash, _KeyEqual,
+                      std::void_t<typename _Hash::is_transparent,
+                                  typename _KeyEqual::is_transparent>>
+    : std::true_type
+{
+};
+
+} // namespace cachew
+
+#endif // CACHEW_HASH_HPP
@@ -0,0 +1,93 @@
+#ifndef CACHEW_INDEX_HPP
+#define CACHEW_INDEX_HPP
+
+#include "hash.hpp"
+#include "swiss_map.hpp"
+
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+
+namespace cachew
+{
+
+// Looks `key` up in a map of `_Index`, `key` may be of any type comparable
+// with `key_type` if the map functors are transparent.
+template <class _Index, class _Map, class _K>
+inline auto index_find( _Map &map, const _K &key )
+{
+    using key_type = typename _Map::key_type;
+
+    if constexpr( std::is_same_v<_K, key_type> ||
+                  ( _Index::heterogeneous_lookup &&
+                    is_transparent<typename _Map::hasher,
+                                   typename _Map::key_equal>::value ) )
+    {
+        return map.find( key );
+    }
+    else
+    {
+        return map.find( key_type( key ) );
+    }
+}
+
+// Node based `std::unordered_map` index. Heterogeneous lookup in
+// `std::unordered_map` requires C++20, before it a lookup by a different key
+// type builds a temporary `key_type`.
+struct std_index
+{
+#ifdef __cpp_lib_generic_unordered_lookup
+    static constexpr bool heterogeneous_lookup = true;
+#else
+    static constexpr bool heterogeneous_lookup = false;
+#endif
+
+    template <class _Key, class _Tp, class _Hash = std::hash<_Key>,
+              class _KeyEqual = std::equal_to<_Key>>
+    using map_type = std::unordered_map<_Key, _Tp, _Hash, _KeyEqual>;
+
+    // Batched lookups are done in two steps: `prepare` for all keys, then
+    // `find` with the returned hint. `std::unordered_map` neither exposes
+    // its buckets nor accepts a precomputed hash, so there is no first step.
+    template <class _Map, class _K>
+    static std::size_t prepare( const _Map & /*map*/,
+                                const _K & /*key*/ ) noexcept
+    {
+        return 0;
+    }
+
+    template <class _Map, class _K>
+    static auto find( _Map &map, const _K &key, std::size_t /*hint*/ )
+    {
+        return index_find<std_index>( map, key );
+    }
+};
+
+// Open addressing index, see `swiss_map`.
+struct swiss_index
+{
+    static constexpr bool heterogeneous_lookup = true;
+
+    template <class _Key, class _Tp, class _Hash = std::hash<_Key>,
+              class _KeyEqual = std::equal_to<_Key>>
+    using map_type = swiss_map<_Key, _Tp, _Hash, _KeyEqual>;
+
+    // Hashes the key and prefetches its control group and slots.
+    template <class _Map, class _K>
+    static std::size_t prepare( const _Map &map, const _K &key )
+    {
+        std::size_t hash = map.hash( key );
+        map.prefetch( hash );
+        return hash;
+    }
+
+    template <class _Map, class _K>
+    static auto find( _Map &map, const _K &key, std::size_t hash )
+    {
+        return map.find( key, hash );
+    }
+};
+
+} // namespace cachew
+
+#endif // CACHEW_INDEX_HPP
@@ -3,27 +3,74 @@
 
 // http://dhruvbird.com/lfu.pdf
 
+#include "basic_cache.hpp"
 #include "cache_iterator.hpp"
+#include "index.hpp"
+#include "promotion.hpp"
+#include "timing_wheel.hpp"
+#include "weigher.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <list>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace cachew
 {
 
-template <class _Key, class _Tp>
-class lfu_cache
+// Frequencies only grow, a key hit often once outranks the keys hit later.
+struct no_aging
+{
+};
+
+// LFU with dynamic aging (LFU-DA). New entries start right above the
+// frequency of the last evicted entry instead of at 1, so keys which are no
+// longer hit are passed by the new ones and evicted. It takes no extra work
+// per entry.
+struct dynamic_aging
+{
+};
+
+// The cache of `lfu_eviction`, use it as `lfu_cache`.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>,
+          class _Weigher  = unit_weigher,
+          class _Clock    = std::chrono::steady_clock,
+          class _Aging    = no_aging>
+class lfu_cache_impl
 {
 public:
     using key_type   = _Key;
     using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+    using weigher    = _Weigher;
+    using clock      = _Clock;
+    using time_point = typename clock::time_point;
 
-    using kv_pair = std::pair<key_type, value_type>;
+    using kv_pair   = std::pair<key_type, value_type>;
+    using lfu_wheel = timing_wheel<key_type>;
+
+    static constexpr time_point NEVER = time_point::max();
+
+    // A key-value pair with its expiration time, the timer is set only if the
+    // entry expires. `moved` is the count of promotions and additions at its
+    // last promotion or addition.
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        time_point                 deadline = NEVER;
+        typename lfu_wheel::handle timer;
+        uint64_t                   moved = 0;
+    };
 
     struct freq_node
     {
-        using values_list = std::list<kv_pair>;
+        using values_list = std::list<entry>;
 
         size_t      frequency;
         values_list values;
@@ -33,7 +80,8 @@ public:
     using node_location_pair =
         std::pair<typename freq_list::iterator,
                   typename freq_node::values_list::iterator>;
-    using lfu_map = std::unordered_map<key_type, node_location_pair>;
+    using lfu_map = typename _Index::template map_type<
+        key_type, node_location_pair, hasher, key_equal>;
 
 private:
     struct accessor
@@ -56,76 +104,225 @@ private:
         const typename lfu_map::const_iterator &_it;
     };
 
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
 public:
     using iterator = cache_const_iterator<accessor, value_type>;
 
-    friend bool operator!=( const lfu_cache &lhs, const lfu_cache &rhs )
+    friend bool operator!=( const lfu_cache_impl &lhs,
+                            const lfu_cache_impl &rhs )
     {
         return !( rhs == lhs );
     }
 
-    explicit lfu_cache( size_t capacity ) noexcept
+    // Entries heavier than `max_weight` are not cached.
+    explicit lfu_cache_impl( size_t  capacity,
+                             size_t  max_weight = UNLIMITED_WEIGHT,
+                             weigher weigher_fn = weigher() ) noexcept(
+        std::is_nothrow_move_constructible_v<weigher> )
         : _capacity( capacity )
+        , _weight( 0 )
+        , _max_weight( max_weight )
+        , _age( 0 )
+        , _moves( 0 )
+        , _weigher( std::move( weigher_fn ) )
     {
     }
 
-    iterator get( const key_type &key )
+    lfu_cache_impl( const lfu_cache_impl &other )
+        : _list( other._list )
+        , _capacity( other._capacity )
+        , _weight( other._weight )
+        , _max_weight( other._max_weight )
+        , _age( other._age )
+        , _moves( other._moves )
+        , _weigher( other._weigher )
+        , _promotion( other._promotion )
+        , _wheel( other._wheel.now() )
     {
-        auto it = _map.find( key );
-        if( it == _map.end() )
+        // `_map` and `_wheel` refer to the nodes of `other` and have to be
+        // rebuilt
+        _map.reserve( other._map.size() );
+        for( auto node = _list.begin(); node != _list.end(); ++node )
         {
-            return iterator{_map.end()};
+            auto &values = node->values;
+            for( auto it = values.begin(); it != values.end(); ++it )
+            {
+                _map.emplace( it->first, node_location_pair( node, it ) );
+                if( it->deadline != NEVER )
+                {
+                    it->timer = _wheel.schedule(
+                        wheel_deadline_ticks( it->deadline ), it->first );
+                }
+            }
         }
-        node_location_pair &location = it->second;
+    }
 
-        promote( location );
+    lfu_cache_impl( lfu_cache_impl &&other )
+        : lfu_cache_impl( 0 )
+    {
+        *this = std::move( other );
+    }
 
-        return iterator( it );
+    lfu_cache_impl &operator=( const lfu_cache_impl &other )
+    {
+        if( this != &other )
+        {
+            lfu_cache_impl tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
     }
 
-    template <class _PutT>
-    void put( const key_type &key, _PutT &&value )
+    // `other` is left empty and keeps its capacity.
+    lfu_cache_impl &operator=( lfu_cache_impl &&other )
     {
-        auto it = _map.find( key );
-        if( it != _map.end() )
+        if( this != &other )
         {
-            node_location_pair &cur_loc = it->second;
+            _list       = std::move( other._list );
+            _map        = std::move( other._map );
+            _capacity   = other._capacity;
+            _weight     = std::exchange( other._weight, 0 );
+            _max_weight = other._max_weight;
+            _age        = std::exchange( other._age, 0 );
+            _moves      = other._moves;
+            _weigher    = std::move( other._weigher );
+            _promotion  = other._promotion;
+            _wheel      = std::move( other._wheel );
+
+            other._list.clear();
+            other._map.clear();
+            other._wheel = lfu_wheel( _wheel.now() );
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
 
-            auto new_loc           = promote( cur_loc );
-            new_loc.second->second = std::forward<_PutT>( value );
+    bool contains( const key_type &key ) const
+    {
+        return contains_impl( key );
+    }
 
-            // it's safe to update internal state as no exceptions are expected
-            // after this line
-            std::swap( cur_loc, new_loc );
-        }
-        else
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return contains_impl( key );
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto node = _list.begin(); node != _list.end(); )
         {
-            if( _map.size() == _capacity && _capacity > 0 )
-            {
-                evict();
-            }
-            auto pos = _list.begin();
-            if( pos == _list.end() )
+            auto &values = node->values;
+            for( auto it = values.begin(); it != values.end(); )
             {
-                _list.emplace_back( freq_node{1} );
-                pos = _list.begin();
-            }
-            freq_node &freq_node = *pos;
-            freq_node.values.emplace_front(
-                std::make_pair( key, std::forward<_PutT>( value ) ) );
-            try
-            {
-                _map.emplace( key,
-                              std::make_pair( pos, freq_node.values.begin() ) );
-            }
-            catch( ... )
-            {
-                // already emplaced `values_list` will not be removed as it
-                // doesn't affect cache consistency
-                freq_node.values.pop_front();
-                throw;
+                auto           pos   = it++;
+                const kv_pair &entry = *pos;
+                if( pred( entry.first, entry.second ) )
+                {
+                    _map.erase( pos->first );
+                    unlink( node_location_pair( node, pos ) );
+                    ++removed;
+                }
             }
+            drop_if_empty( node++ );
         }
+        return removed;
+    }
+
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _wheel  = lfu_wheel( _wheel.now() );
+        _weight = 0;
+        _age    = 0;
+    }
+
+    // An entry put without TTL never expires.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( !_wheel.empty() )
+        {
+            expire( clock::now() );
+        }
+        put_impl( key, std::forward<_PutT>( value ), NEVER );
+    }
+
+    // The entry expires after `ttl`. Expired entries are not returned and
+    // are removed by `get` or, in order of expiration, by `put` and `expire`
+    // calls. They are counted by `size` until they are removed.
+    template <class _PutT, class _Rep, class _Period>
+    void put( const key_type &key, _PutT &&value,
+              const std::chrono::duration<_Rep, _Period> &ttl )
+    {
+        time_point now = clock::now();
+        expire( now );
+        put_impl( key, std::forward<_PutT>( value ),
+                  now + std::chrono::ceil<typename clock::duration>( ttl ) );
+    }
+
+    // Returns the entry of `key` and `true` if it was added, its value is
+    // built from `args` only if there was no entry. The returned iterator is
+    // `end()` if the new entry is heavier than `max_weight`.
+    template <class... _Args>
+    std::pair<iterator, bool> try_emplace( const key_type &key,
+                                           _Args &&... args )
+    {
+        return emplace_impl(
+            key, [&]( typename freq_node::values_list &list ) {
+                list.emplace_front(
+                    std::piecewise_construct, std::forward_as_tuple( key ),
+                    std::forward_as_tuple( std::forward<_Args>( args )... ) );
+            } );
+    }
+
+    // Returns the entry of `key`, adding the result of `fn( key )` if there
+    // is no entry, or `end()` if the result is heavier than `max_weight`.
+    template <class _Fn>
+    iterator get_or_compute( const key_type &key, _Fn &&fn )
+    {
+        auto res =
+            emplace_impl( key, [&]( typename freq_node::values_list &list ) {
+                list.emplace_front( key, std::invoke( fn, key ) );
+            } );
+        return res.first;
+    }
+
+    // Removes all expired entries.
+    void expire()
+    {
+        expire( clock::now() );
     }
 
     size_t capacity() const noexcept
@@ -133,11 +330,98 @@ public:
         return _capacity;
     }
 
+    // The new capacity bounds the cache at once: while the cache is over it,
+    // an insert never grows it and every operation but `contains` evicts up
+    // to `TRIM_BATCH` entries. The index is reserved for a bigger capacity.
+    void resize( size_t capacity )
+    {
+        if( capacity > _capacity )
+        {
+            _map.reserve( capacity + 1 );
+        }
+        _capacity = capacity;
+    }
+
     size_t size() const noexcept
     {
         return _map.size();
     }
 
+    size_t weight() const noexcept
+    {
+        return _weight;
+    }
+
+    size_t max_weight() const noexcept
+    {
+        return _max_weight;
+    }
+
+    // The hits of `get`, `try_emplace` and `get_or_compute` count as
+    // `policy` decides, a `put` always counts.
+    void set_promotion( const promotion_policy &policy ) noexcept
+    {
+        _promotion = policy;
+    }
+
+    const promotion_policy &promotion() const noexcept
+    {
+        return _promotion;
+    }
+
+    // Number of frequency nodes, never more than `size()`.
+    size_t bucket_count() const noexcept
+    {
+        return _list.size();
+    }
+
+    // Up to `k` keys of the highest frequencies with their frequencies, from
+    // the highest one and the most recent entry of a frequency. Walks the
+    // frequency nodes from the top, so the time is proportional to `k`
+    // plus the number of nodes and expired entries passed on the way.
+    std::vector<std::pair<key_type, size_t>> top_k( size_t k ) const
+    {
+        std::vector<std::pair<key_type, size_t>> top;
+        top.reserve( std::min( k, _map.size() ) );
+        for( auto node = _list.rbegin(); node != _list.rend(); ++node )
+        {
+            for( const entry &e : node->values )
+            {
+                if( top.size() == k )
+                {
+                    return top;
+                }
+                if( !expired( e ) )
+                {
+                    top.emplace_back( e.first, node->frequency );
+                }
+            }
+        }
+        return top;
+    }
+
+    // Pairs of a frequency and the number of entries with it, from the
+    // lowest frequency. Entries are not visited, only the frequency nodes,
+    // so the expired entries which are not removed yet are counted too.
+    // With `dynamic_aging` the frequencies include the age.
+    std::vector<std::pair<size_t, size_t>> frequency_histogram() const
+    {
+        std::vector<std::pair<size_t, size_t>> histogram;
+        histogram.reserve( _list.size() );
+        for( const freq_node &node : _list )
+        {
+            histogram.emplace_back( node.frequency, node.values.size() );
+        }
+        return histogram;
+    }
+
+    // Frequency of the last evicted entry with `dynamic_aging`, new entries
+    // start at `age() + 1`. Always 0 with `no_aging`.
+    size_t age() const noexcept
+    {
+        return _age;
+    }
+
     iterator begin() const noexcept
     {
         return iterator( _map.begin() );
@@ -149,38 +433,361 @@ public:
     }
 
 private:
+    static constexpr size_t TRIM_BATCH = 64;
+
+    // Evicts a batch of the entries over the capacity left by `resize`.
+    void trim()
+    {
+        for( size_t i = 0; i < TRIM_BATCH && _map.size() > _capacity; ++i )
+        {
+            evict();
+        }
+    }
+
+    template <class _PutT>
+    void put_impl( const key_type &key, _PutT &&value, time_point deadline )
+    {
+        trim();
+
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            update_at( it, std::forward<_PutT>( value ), deadline );
+            return;
+        }
+        insert_at( it, deadline, [&]( typename freq_node::values_list &list ) {
+            list.emplace_front( key, std::forward<_PutT>( value ) );
+        } );
+    }
+
+    template <class _Make>
+    std::pair<iterator, bool> emplace_impl( const key_type &key, _Make &&make )
+    {
+        if( !_wheel.empty() )
+        {
+            expire( clock::now() );
+        }
+        trim();
+
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            if( !expired( *( it->second.second ) ) )
+            {
+                promote_hit( it->second );
+                return { iterator( it ), false };
+            }
+            auto node = it->second.first;
+            unlink( it->second );
+            drop_if_empty( node );
+        }
+        if( !insert_at( it, NEVER, make ) )
+        {
+            return { end(), false };
+        }
+        return { iterator( it ), true };
+    }
+
+    template <class _PutT>
+    void update_at( typename lfu_map::iterator it, _PutT &&value,
+                    time_point deadline )
+    {
+        node_location_pair &cur_loc = it->second;
+
+        // `promote` may drop the old node, so the map gets the new location
+        // before the value is assigned, which may throw
+        cur_loc             = promote( cur_loc );
+        entry   &entry      = *( cur_loc.second );
+        size_t   old_weight = _weigher( entry.first, entry.second );
+        entry.second        = std::forward<_PutT>( value );
+
+        size_t new_weight = _weigher( entry.first, entry.second );
+        _weight -= old_weight;
+        if( new_weight > _max_weight )
+        {
+            cancel_timer( entry );
+            cur_loc.first->values.erase( cur_loc.second );
+            drop_if_empty( cur_loc.first );
+            _map.erase( it );
+            return;
+        }
+        _weight += new_weight;
+        set_timer( entry, deadline );
+        while( _weight > _max_weight )
+        {
+            evict();
+        }
+    }
+
+    // `it` is a just added `_map` element, `make` adds its entry to the
+    // front of the list it is given. Returns `false` if the entry is too heavy
+    // to keep.
+    template <class _Make>
+    bool insert_at( typename lfu_map::iterator it, time_point deadline,
+                    _Make &&make )
+    {
+        // nothing is cached at capacity 0
+        if( _capacity == 0 )
+        {
+            _map.erase( it );
+            return false;
+        }
+        // the entry is made and weighed before it is linked, so eviction
+        // never picks it
+        typename freq_node::values_list entry_list;
+        try
+        {
+            make( entry_list );
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        entry  &entry  = entry_list.front();
+        size_t  weight = _weigher( entry.first, entry.second );
+        if( weight > _max_weight )
+        {
+            _map.erase( it );
+            return false;
+        }
+        if( _map.size() > _capacity )
+        {
+            evict();
+        }
+        while( weight > _max_weight - _weight )
+        {
+            evict();
+        }
+        entry.moved = ++_moves;
+
+        try
+        {
+            // the timer is set first, so a frequency node is emplaced only
+            // when nothing can fail after it
+            set_timer( entry, deadline );
+
+            auto pos = _list.begin();
+            if( pos != _list.end() && pos->frequency <= _age )
+            {
+                // the node of the last evicted entry
+                ++pos;
+            }
+            if( pos == _list.end() || pos->frequency != _age + 1 )
+            {
+                pos = _list.emplace( pos, freq_node{_age + 1} );
+            }
+
+            freq_node &freq_node = *pos;
+            freq_node.values.splice( freq_node.values.begin(), entry_list );
+            it->second = std::make_pair( pos, freq_node.values.begin() );
+        }
+        catch( ... )
+        {
+            cancel_timer( entry );
+            _map.erase( it );
+            throw;
+        }
+        _weight += weight;
+        return true;
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        trim();
+
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator{_map.end()};
+        }
+        if( expired( *( it->second.second ) ) )
+        {
+            erase_at( it );
+            return iterator{_map.end()};
+        }
+        promote_hit( it->second );
+
+        return iterator( it );
+    }
+
+    template <class _K>
+    bool contains_impl( const _K &key ) const
+    {
+        auto it = index_find<_Index>( _map, key );
+        return it != _map.end() && !expired( *( it->second.second ) );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        erase_at( it );
+        return true;
+    }
+
+    void erase_at( typename lfu_map::iterator it )
+    {
+        auto node = it->second.first;
+        unlink( it->second );
+        drop_if_empty( node );
+        _map.erase( it );
+    }
+
+    // Frequency nodes live as long as they have entries.
+    void drop_if_empty( typename freq_list::iterator node ) noexcept
+    {
+        if( node->values.empty() )
+        {
+            _list.erase( node );
+        }
+    }
+
+    // Removes the entry from its frequency node only, the caller drops the
+    // node if it gets empty.
+    void unlink( const node_location_pair &location )
+    {
+        entry &entry = *( location.second );
+        cancel_timer( entry );
+        _weight -= _weigher( entry.first, entry.second );
+        location.first->values.erase( location.second );
+    }
+
+    // Removes the entries which expire by `now`.
+    void expire( time_point now )
+    {
+        _wheel.advance( wheel_ticks( now ), [this]( const key_type &key ) {
+            auto it = _map.find( key );
+            // the timer is already gone
+            it->second.second->deadline = NEVER;
+            erase_at( it );
+        } );
+    }
+
+    // Schedules a new timer first, so the entry keeps its timer on failure.
+    void set_timer( entry &entry, time_point deadline )
+    {
+        if( deadline == NEVER )
+        {
+            cancel_timer( entry );
+            return;
+        }
+        auto timer =
+            _wheel.schedule( wheel_deadline_ticks( deadline ), entry.first );
+        cancel_timer( entry );
+        entry.deadline = deadline;
+        entry.timer    = timer;
+    }
+
+    void cancel_timer( entry &entry ) noexcept
+    {
+        if( entry.deadline != NEVER )
+        {
+            _wheel.cancel( entry.timer );
+            entry.deadline = NEVER;
+        }
+    }
+
+    static bool expired( const entry &entry )
+    {
+        return entry.deadline != NEVER && entry.deadline <= clock::now();
+    }
+
+    // Moves the entry to the node of the next frequency, a node left with
+    // this entry only is relabeled instead.
     node_location_pair promote( node_location_pair location )
     {
-        auto  new_pos  = std::next( location.first );
-        auto &cur_node = *( location.first );
-        if( new_pos == _list.end() )
+        auto   cur       = location.first;
+        auto   new_pos   = std::next( cur );
+        size_t frequency = cur->frequency + 1;
+
+        location.second->moved = ++_moves;
+        if( new_pos == _list.end() || new_pos->frequency != frequency )
         {
-            _list.emplace_back( freq_node{cur_node.frequency + 1} );
-            new_pos = std::prev( _list.end() );
+            if( cur->values.size() == 1 )
+            {
+                cur->frequency = frequency;
+                return location;
+            }
+            new_pos = _list.emplace( new_pos, freq_node{frequency} );
         }
         freq_node &freq_node = *new_pos;
-        freq_node.values.splice( freq_node.values.begin(),
-                                 ( *location.first ).values, location.second );
+        freq_node.values.splice( freq_node.values.begin(), cur->values,
+                                 location.second );
         // location.second already should be updated
         location.first = new_pos;
+        drop_if_empty( cur );
 
         return location;
     }
 
+    // Promotes a hit entry if `_promotion` lets it.
+    void promote_hit( node_location_pair &location )
+    {
+        if( _promotion.promotes( _moves - location.second->moved ) )
+        {
+            location = promote( location );
+        }
+    }
+
     void evict()
     {
-        freq_node &freq_node = *( _list.begin() );
-        auto       to_del    = std::prev( freq_node.values.end() );
+        // the first frequency node is never empty
+        auto node = _list.begin();
+        if constexpr( std::is_same_v<_Aging, dynamic_aging> )
+        {
+            _age = node->frequency;
+        }
+        auto to_del = std::prev( node->values.end() );
 
+        cancel_timer( *to_del );
+        _weight -= _weigher( to_del->first, to_del->second );
         _map.erase( ( *to_del ).first );
-        freq_node.values.erase( to_del );
+        node->values.erase( to_del );
+        drop_if_empty( node );
     }
 
-    freq_list _list;
-    lfu_map   _map;
-    size_t    _capacity;
+    freq_list        _list;
+    lfu_map          _map;
+    size_t           _capacity;
+    size_t           _weight;
+    size_t           _max_weight;
+    size_t           _age;
+    uint64_t         _moves;
+    weigher          _weigher;
+    promotion_policy _promotion;
+    lfu_wheel        _wheel;
 };
 
+// LFU eviction for `basic_cache`.
+template <class _Weigher = unit_weigher,
+          class _Clock   = std::chrono::steady_clock,
+          class _Aging   = no_aging>
+struct lfu_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = lfu_cache_impl<_Key, _Tp, _Index, _Hash, _KeyEqual,
+                                      _Weigher, _Clock, _Aging>;
+};
+
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>,
+          class _Weigher  = unit_weigher,
+          class _Clock    = std::chrono::steady_clock,
+          class _Aging    = no_aging>
+using lfu_cache =
+    basic_cache<_Key, _Tp, lfu_eviction<_Weigher, _Clock, _Aging>, _Index,
+                list_storage, no_sync, _Hash, _KeyEqual>;
+
 } // namespace cachew
 
 #endif // CACHEW_LFU_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,605 @@
+#ifndef CACHEW_LIRS_CACHE_HPP
+#define CACHEW_LIRS_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// LIRS cache. Keys are ranked by the recency of their previous access, their
+// inter-reference recency, rather than of the last one. Most of the capacity
+// holds LIR keys, the keys reused soonest, and about 1% holds HIR keys in a
+// FIFO queue, which are the only ones evicted. The LIRS stack keeps keys in
+// recency order down to the least recent LIR key, a HIR key hit while still
+// in the stack becomes LIR in its place. So a loop over more keys than the
+// capacity keeps most of them cached, and a scan only passes through the
+// queue. Evicted keys still in the stack are kept as non-resident, up to
+// the capacity, and the oldest of them are forgotten first.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class lirs_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        bool is_lir = false;
+    };
+
+    // Resident entries, the LIR ones followed by the HIR queue from its
+    // front.
+    using lirs_list = std::list<entry>;
+    // The LIRS stack from its top.
+    using lirs_stack = std::list<key_type>;
+    // Stack nodes of the non-resident keys, the oldest first.
+    using ghost_list = std::list<typename lirs_stack::iterator>;
+
+    struct record
+    {
+        typename lirs_list::iterator  entry;
+        typename lirs_stack::iterator stack;
+        typename ghost_list::iterator ghost;
+        bool                          resident = false;
+        bool                          in_stack = false;
+    };
+
+    using lirs_map =
+        typename _Index::template map_type<key_type, record, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename lirs_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const lirs_cache &lhs, const lirs_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // The HIR queue takes 1% of the capacity, at least one entry.
+    explicit lirs_cache( size_t capacity )
+        : lirs_cache( capacity, std::max<size_t>( capacity / 100, 1 ) )
+    {
+    }
+
+    // `hir_capacity` is at least 1 and at most `capacity`.
+    lirs_cache( size_t capacity, size_t hir_capacity )
+        : _hir( _list.end() )
+        , _capacity( capacity )
+        , _hir_capacity(
+              std::min( std::max<size_t>( hir_capacity, 1 ), capacity ) )
+        , _lir_size( 0 )
+    {
+    }
+
+    lirs_cache( const lirs_cache &other )
+        : _list( other._list )
+        , _hir( _list.end() )
+        , _stack( other._stack )
+        , _capacity( other._capacity )
+        , _hir_capacity( other._hir_capacity )
+        , _lir_size( other._lir_size )
+    {
+        // `_map`, `_hir` and `_ghosts` refer to the nodes of `other` and have
+        // to be rebuilt
+        _map.reserve( other._map.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            record &rec  = _map.try_emplace( it->first ).first->second;
+            rec.entry    = it;
+            rec.resident = true;
+        }
+        _hir = std::find_if( _list.begin(), _list.end(),
+                             []( const entry &e ) { return !e.is_lir; } );
+
+        for( auto it = _stack.begin(); it != _stack.end(); ++it )
+        {
+            record &rec  = _map.try_emplace( *it ).first->second;
+            rec.stack    = it;
+            rec.in_stack = true;
+        }
+        for( auto node : other._ghosts )
+        {
+            record &rec = _map.find( *node )->second;
+            rec.ghost   = _ghosts.insert( _ghosts.end(), rec.stack );
+        }
+    }
+
+    lirs_cache( lirs_cache &&other )
+        : lirs_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    lirs_cache &operator=( const lirs_cache &other )
+    {
+        if( this != &other )
+        {
+            lirs_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    lirs_cache &operator=( lirs_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            bool hir_tail = other._hir == other._list.end();
+            auto hir      = other._hir;
+
+            _list         = std::move( other._list );
+            _hir          = hir_tail ? _list.end() : hir;
+            _stack        = std::move( other._stack );
+            _ghosts       = std::move( other._ghosts );
+            _map          = std::move( other._map );
+            _capacity     = other._capacity;
+            _hir_capacity = other._hir_capacity;
+            _lir_size     = other._lir_size;
+
+            other.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return contains_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return contains_impl( key );
+    }
+
+    // An erased key is forgotten, it is not kept as non-resident.
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                forget( _map.find( pos->first ) );
+                ++removed;
+            }
+        }
+        prune();
+        return removed;
+    }
+
+    // Removes all entries and the non-resident keys.
+    void clear() noexcept
+    {
+        _map.clear();
+        _ghosts.clear();
+        _stack.clear();
+        _list.clear();
+        _hir      = _list.end();
+        _lir_size = 0;
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key );
+        if( it->second.resident )
+        {
+            it->second.entry->second = std::forward<_PutT>( value );
+            hit( it->second );
+            return;
+        }
+
+        // the new nodes are made before anything is evicted for them
+        lirs_list  pending;
+        lirs_stack pending_node;
+        ghost_list pending_ghost;
+        try
+        {
+            pending.emplace_back( key, std::forward<_PutT>( value ) );
+            if( inserted )
+            {
+                pending_node.push_back( key );
+            }
+            if( _list.size() >= _capacity )
+            {
+                pending_ghost.emplace_back();
+            }
+        }
+        catch( ... )
+        {
+            if( inserted )
+            {
+                _map.erase( it );
+            }
+            throw;
+        }
+
+        if( !inserted )
+        {
+            // so `evict` does not forget the key
+            _ghosts.erase( it->second.ghost );
+        }
+        if( _list.size() >= _capacity )
+        {
+            evict( pending_ghost );
+        }
+        // `evict` may rehash `_map`
+        record &rec  = _map.find( key )->second;
+        rec.resident = true;
+        if( inserted )
+        {
+            _stack.splice( _stack.begin(), pending_node );
+            rec.stack    = _stack.begin();
+            rec.in_stack = true;
+        }
+        else
+        {
+            _stack.splice( _stack.begin(), _stack, rec.stack );
+        }
+
+        if( inserted && _lir_size < lir_capacity() )
+        {
+            // the LIR set is filled first
+            _list.splice( _list.begin(), pending );
+            rec.entry         = _list.begin();
+            rec.entry->is_lir = true;
+            ++_lir_size;
+            // the keys left below by an emptied LIR set are pruned
+            prune();
+            return;
+        }
+        _list.splice( _list.end(), pending );
+        rec.entry = std::prev( _list.end() );
+        if( _hir == _list.end() )
+        {
+            _hir = rec.entry;
+        }
+        if( !inserted )
+        {
+            promote( rec.entry );
+        }
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t hir_capacity() const noexcept
+    {
+        return _hir_capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _list.size();
+    }
+
+    // Number of LIR entries.
+    size_t lir_size() const noexcept
+    {
+        return _lir_size;
+    }
+
+    // Number of non-resident keys kept in the stack.
+    size_t ghost_size() const noexcept
+    {
+        return _ghosts.size();
+    }
+
+    // LIR entries go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    void hit( record &rec )
+    {
+        auto pos = rec.entry;
+        if( pos->is_lir )
+        {
+            bool bottom = rec.stack == std::prev( _stack.end() );
+            _stack.splice( _stack.begin(), _stack, rec.stack );
+            if( bottom )
+            {
+                prune();
+            }
+            return;
+        }
+        if( rec.in_stack )
+        {
+            _stack.splice( _stack.begin(), _stack, rec.stack );
+            promote( pos );
+            return;
+        }
+        // the stack node is made first, so a failure changes nothing
+        rec.stack    = _stack.insert( _stack.begin(), pos->first );
+        rec.in_stack = true;
+        if( _lir_size < lir_capacity() )
+        {
+            // the LIR set was emptied by erasing, it is filled first
+            make_lir( pos );
+            prune();
+            return;
+        }
+        make_hir( pos );
+    }
+
+    // Evicts the front of the HIR queue, it stays in the stack as a
+    // non-resident key if it is there.
+    void evict( ghost_list &pending_ghost )
+    {
+        auto    victim = _hir;
+        auto    it     = _map.find( victim->first );
+        record &rec    = it->second;
+        unlink( victim );
+        if( !rec.in_stack )
+        {
+            _map.erase( it );
+            return;
+        }
+        rec.resident = false;
+        _ghosts.splice( _ghosts.end(), pending_ghost );
+        rec.ghost    = std::prev( _ghosts.end() );
+        *rec.ghost   = rec.stack;
+
+        if( _ghosts.size() > _capacity )
+        {
+            // the oldest non-resident key is never the stack bottom
+            auto oldest = _map.find( *_ghosts.front() );
+            _stack.erase( oldest->second.stack );
+            _ghosts.pop_front();
+            _map.erase( oldest );
+        }
+    }
+
+    // Removes the HIR keys from the bottom of the stack, so a LIR key is
+    // there. A stack without LIR keys is emptied.
+    void prune()
+    {
+        while( !_stack.empty() )
+        {
+            auto    it  = _map.find( _stack.back() );
+            record &rec = it->second;
+            if( rec.resident && rec.entry->is_lir )
+            {
+                return;
+            }
+            _stack.pop_back();
+            rec.in_stack = false;
+            if( !rec.resident )
+            {
+                _ghosts.erase( rec.ghost );
+                _map.erase( it );
+            }
+        }
+    }
+
+    size_t lir_capacity() const noexcept
+    {
+        return _capacity - _hir_capacity;
+    }
+
+    // A HIR key reused while it is in the stack becomes LIR, it was reused
+    // sooner than the least recent LIR key, which becomes the last HIR one
+    // once the LIR set is full.
+    void promote( typename lirs_list::iterator pos )
+    {
+        if( _lir_size < lir_capacity() )
+        {
+            make_lir( pos );
+            prune();
+            return;
+        }
+        if( _lir_size == 0 )
+        {
+            // no LIR set at all
+            make_hir( pos );
+            return;
+        }
+        // the bottom is the least recent LIR key, not `pos`
+        prune();
+        make_lir( pos );
+
+        auto    it  = _map.find( _stack.back() );
+        record &rec = it->second;
+        _stack.pop_back();
+        rec.in_stack = false;
+        make_hir( rec.entry );
+        prune();
+    }
+
+    void make_lir( typename lirs_list::iterator pos )
+    {
+        if( pos == _hir )
+        {
+            ++_hir;
+        }
+        _list.splice( _list.begin(), _list, pos );
+        pos->is_lir = true;
+        ++_lir_size;
+    }
+
+    // Moves the entry to the back of the HIR queue.
+    void make_hir( typename lirs_list::iterator pos )
+    {
+        if( pos->is_lir )
+        {
+            pos->is_lir = false;
+            --_lir_size;
+        }
+        else if( pos == _hir )
+        {
+            ++_hir;
+        }
+        _list.splice( _list.end(), _list, pos );
+        if( _hir == _list.end() )
+        {
+            _hir = pos;
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() || !it->second.resident )
+        {
+            return iterator( _list.end() );
+        }
+        hit( it->second );
+
+        return iterator( it->second.entry );
+    }
+
+    template <class _K>
+    bool contains_impl( const _K &key ) const
+    {
+        auto it = index_find<_Index>( _map, key );
+        return it != _map.end() && it->second.resident;
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() || !it->second.resident )
+        {
+            return false;
+        }
+        forget( it );
+        prune();
+        return true;
+    }
+
+    // Removes a resident key with its stack node.
+    void forget( typename lirs_map::iterator it )
+    {
+        record &rec = it->second;
+        if( rec.in_stack )
+        {
+            _stack.erase( rec.stack );
+        }
+        unlink( rec.entry );
+        _map.erase( it );
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename lirs_list::iterator pos ) noexcept
+    {
+        if( pos == _hir )
+        {
+            ++_hir;
+        }
+        if( pos->is_lir )
+        {
+            --_lir_size;
+        }
+        _list.erase( pos );
+    }
+
+    lirs_list                   _list;
+    typename lirs_list::iterator _hir;
+    lirs_stack                  _stack;
+    ghost_list                  _ghosts;
+    lirs_map                    _map;
+    size_t                      _capacity;
+    size_t                      _hir_capacity;
+    size_t                      _lir_size;
+};
+
+// LIRS eviction for `basic_cache`.
+struct lirs_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = lirs_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_LIRS_CACHE_HPP
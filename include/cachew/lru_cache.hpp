@@ -1,26 +1,63 @@
 #ifndef CACHEW_LRU_CACHE_HPP
 #define CACHEW_LRU_CACHE_HPP
 
+#include "basic_cache.hpp"
 #include "cache_iterator.hpp"
+#include "index.hpp"
+#include "promotion.hpp"
+#include "storage.hpp"
+#include "timing_wheel.hpp"
+#include "weigher.hpp"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
 #include <list>
-#include <unordered_map>
+#include <utility>
 
 namespace cachew
 {
 
-template <class _Key, class _Tp>
-class lru_cache
+// The cache of `lru_eviction`, use it as `lru_cache`.
+template <class _Key, class _Tp, class _Storage = list_storage,
+          class _Index = std_index, class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>,
+          class _Weigher  = unit_weigher,
+          class _Clock    = std::chrono::steady_clock>
+class lru_cache_impl
 {
 public:
     using key_type   = _Key;
     using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+    using weigher    = _Weigher;
+    using clock      = _Clock;
+    using time_point = typename clock::time_point;
 
     using kv_pair = std::pair<key_type, value_type>;
 
-    using lru_list = std::list<kv_pair>;
-    using lru_map  = std::unordered_map<key_type, typename lru_list::iterator>;
+    struct entry;
+
+    using lru_list = typename _Storage::template list_type<entry>;
+    using lru_map  = typename _Index::template map_type<
+        key_type, typename lru_list::iterator, hasher, key_equal>;
+    using lru_wheel = timing_wheel<typename lru_list::iterator>;
+
+    static constexpr time_point NEVER = time_point::max();
+
+    // A key-value pair with its expiration time, the timer is set only if the
+    // entry expires. `moved` is the count of moves to the front at its last
+    // move there.
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        time_point                 deadline = NEVER;
+        typename lru_wheel::handle timer;
+        uint64_t                   moved = 0;
+    };
 
 private:
     struct accessor
@@ -43,55 +80,312 @@ private:
         const const_iterator &_it;
     };
 
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
 public:
     using iterator = cache_const_iterator<accessor, value_type>;
 
-    friend bool operator!=( const lru_cache &lhs, const lru_cache &rhs )
+    friend bool operator!=( const lru_cache_impl &lhs,
+                            const lru_cache_impl &rhs )
     {
         return !( rhs == lhs );
     }
 
-    explicit lru_cache( size_t capacity ) noexcept
-        : _capacity( capacity )
+    // Entries heavier than `max_weight` are not cached.
+    explicit lru_cache_impl( size_t  capacity,
+                             size_t  max_weight = UNLIMITED_WEIGHT,
+                             weigher weigher_fn = weigher() ) noexcept(
+        !_Storage::preallocated &&
+        std::is_nothrow_move_constructible_v<weigher> )
+        : _list( _Storage::template make<entry>( capacity ) )
+        , _capacity( capacity )
+        , _weight( 0 )
+        , _max_weight( max_weight )
+        , _moves( 0 )
+        , _weigher( std::move( weigher_fn ) )
     {
+        if constexpr( _Storage::preallocated )
+        {
+            // a new entry is indexed before an old one is evicted
+            _map.reserve( capacity + 1 );
+        }
+    }
+
+    lru_cache_impl( const lru_cache_impl &other )
+        : _list( other._list )
+        , _capacity( other._capacity )
+        , _weight( other._weight )
+        , _max_weight( other._max_weight )
+        , _moves( other._moves )
+        , _weigher( other._weigher )
+        , _promotion( other._promotion )
+        , _wheel( other._wheel.now() )
+    {
+        // `_map` and `_wheel` refer to the nodes of `other` and have to be
+        // rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+            if( it->deadline != NEVER )
+            {
+                it->timer = _wheel.schedule(
+                    wheel_deadline_ticks( it->deadline ), it );
+            }
+        }
+    }
+
+    lru_cache_impl( lru_cache_impl &&other )
+        : lru_cache_impl( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    lru_cache_impl &operator=( const lru_cache_impl &other )
+    {
+        if( this != &other )
+        {
+            lru_cache_impl tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    // `other` is left empty. A slab is moved with its nodes, so `other`
+    // keeps its capacity only with list storage.
+    lru_cache_impl &operator=( lru_cache_impl &&other )
+    {
+        if( this != &other )
+        {
+            _list       = std::move( other._list );
+            _map        = std::move( other._map );
+            _capacity   = other._capacity;
+            _weight     = std::exchange( other._weight, 0 );
+            _max_weight = other._max_weight;
+            _moves      = other._moves;
+            _weigher    = std::move( other._weigher );
+            _promotion  = other._promotion;
+            _wheel      = std::move( other._wheel );
+
+            if constexpr( _Storage::preallocated )
+            {
+                other._capacity = 0;
+            }
+            other._list.clear();
+            other._map.clear();
+            other._wheel = lru_wheel( _wheel.now() );
+        }
+        return *this;
     }
 
     iterator get( const key_type &key )
     {
-        auto it = _map.find( key );
-        if( it == _map.end() )
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return contains_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return contains_impl( key );
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
         {
-            return iterator( _list.end() );
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
         }
-        _list.splice( _list.begin(), _list, it->second );
+        return removed;
+    }
 
-        return iterator( it->second );
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _wheel  = lru_wheel( _wheel.now() );
+        _weight = 0;
     }
 
+    // An entry put without TTL never expires.
     template <class _PutT>
     void put( const key_type &key, _PutT &&value )
     {
-        auto it = _map.find( key );
-        if( it != _map.end() )
+        if( !_wheel.empty() )
         {
-            _list.splice( _list.begin(), _list, it->second );
-            it->second->second = value;
+            expire( clock::now() );
         }
-        if( _map.size() == _capacity )
+        put_impl( key, std::forward<_PutT>( value ), NEVER );
+    }
+
+    // The entry expires after `ttl`. Expired entries are not returned and
+    // are removed by `get` or, in order of expiration, by `put` and `expire`
+    // calls. They are counted by `size` until they are removed.
+    template <class _PutT, class _Rep, class _Period>
+    void put( const key_type &key, _PutT &&value,
+              const std::chrono::duration<_Rep, _Period> &ttl )
+    {
+        time_point now = clock::now();
+        expire( now );
+        put_impl( key, std::forward<_PutT>( value ),
+                  now + std::chrono::ceil<typename clock::duration>( ttl ) );
+    }
+
+    // Returns the entry of `key` and `true` if it was added, its value is
+    // built from `args` only if there was no entry. The returned iterator is
+    // `end()` if the new entry is heavier than `max_weight` or the capacity
+    // is 0.
+    template <class... _Args>
+    std::pair<iterator, bool> try_emplace( const key_type &key,
+                                           _Args &&... args )
+    {
+        return emplace_impl( key, [&]() {
+            _list.emplace_front(
+                std::piecewise_construct, std::forward_as_tuple( key ),
+                std::forward_as_tuple( std::forward<_Args>( args )... ) );
+        } );
+    }
+
+    // Returns the entry of `key`, adding the result of `fn( key )` if there
+    // is no entry, or `end()` if the result is heavier than `max_weight` or
+    // the capacity is 0.
+    template <class _Fn>
+    iterator get_or_compute( const key_type &key, _Fn &&fn )
+    {
+        auto res = emplace_impl( key, [&]() {
+            _list.emplace_front( key, std::invoke( fn, key ) );
+        } );
+        return res.first;
+    }
+
+    // Removes all expired entries.
+    void expire()
+    {
+        expire( clock::now() );
+    }
+
+    // Looks the keys of [first, last) up and writes an `iterator` for each of
+    // them to `out`, `end()` for a miss. Keys are processed in batches: the
+    // index is prefetched for the whole batch, then the found entries, and
+    // only then the hits are promoted, in the same order as a loop of `get`.
+    template <class _ForwardIt, class _OutputIt>
+    _OutputIt get_many( _ForwardIt first, _ForwardIt last, _OutputIt out )
+    {
+        std::array<const key_type *, BATCH_SIZE>           keys;
+        std::array<std::size_t, BATCH_SIZE>                hints;
+        std::array<typename lru_map::iterator, BATCH_SIZE> found;
+
+        // without timers no entry expires
+        time_point now = _wheel.empty() ? time_point::min() : clock::now();
+
+        // the returned iterators have to stay valid
+        trim();
+
+        while( first != last )
         {
-            auto to_del = _list.back().first;
-            _list.pop_back();
-            _map.erase( to_del );
+            size_t count = 0;
+            for( ; first != last && count < BATCH_SIZE; ++first, ++count )
+            {
+                keys[count]  = &*first;
+                hints[count] = _Index::prepare( _map, *keys[count] );
+            }
+            for( size_t i = 0; i < count; ++i )
+            {
+                found[i] = _Index::find( _map, *keys[i], hints[i] );
+                if( found[i] != _map.end() )
+                {
+                    prefetch( &*( found[i]->second ) );
+                }
+            }
+            for( size_t i = 0; i < count; ++i )
+            {
+                // expired entries are left to the timers, `found` may hold
+                // the same entry more than once
+                if( found[i] == _map.end() ||
+                    found[i]->second->deadline <= now )
+                {
+                    *out++ = end();
+                    continue;
+                }
+                promote_hit( found[i]->second );
+                *out++ = iterator( found[i]->second );
+            }
         }
-        _list.emplace_front( key, std::forward<_PutT>( value ) );
-        try
+        return out;
+    }
+
+    // Puts the key-value pairs of [first, last), as a loop of `put` does, with
+    // the index of each batch prefetched in advance.
+    template <class _ForwardIt>
+    void put_many( _ForwardIt first, _ForwardIt last )
+    {
+        std::array<_ForwardIt, BATCH_SIZE>  items;
+        std::array<std::size_t, BATCH_SIZE> hints;
+
+        if( !_wheel.empty() )
         {
-            _map.emplace( key, _list.begin() );
+            expire( clock::now() );
         }
-        catch( ... )
+        while( first != last )
         {
-            _list.pop_front();
-            throw;
+            trim();
+
+            size_t count = 0;
+            for( ; first != last && count < BATCH_SIZE; ++first, ++count )
+            {
+                items[count] = first;
+                hints[count] = _Index::prepare( _map, first->first );
+            }
+            for( size_t i = 0; i < count; ++i )
+            {
+                const key_type &key   = items[i]->first;
+                const auto     &value = items[i]->second;
+
+                auto it = _Index::find( _map, key, hints[i] );
+                if( it != _map.end() )
+                {
+                    update_at( it, value, NEVER );
+                    continue;
+                }
+                insert_at( _map.try_emplace( key ).first, NEVER,
+                           [&]() { _list.emplace_front( key, value ); } );
+            }
         }
     }
 
@@ -100,11 +394,53 @@ public:
         return _capacity;
     }
 
+    // The new capacity bounds the cache at once: while the cache is over it,
+    // an insert never grows it and every operation but `contains` evicts up
+    // to `TRIM_BATCH` entries. The index is reserved for a bigger capacity.
+    void resize( size_t capacity )
+    {
+        if( capacity > _capacity )
+        {
+            _map.reserve( capacity + 1 );
+        }
+        if constexpr( _Storage::preallocated )
+        {
+            if( capacity > _list.capacity() )
+            {
+                _list.reserve( capacity );
+                relink();
+            }
+        }
+        _capacity = capacity;
+    }
+
     size_t size() const noexcept
     {
         return _map.size();
     }
 
+    size_t weight() const noexcept
+    {
+        return _weight;
+    }
+
+    size_t max_weight() const noexcept
+    {
+        return _max_weight;
+    }
+
+    // The hits of `get`, `get_many`, `try_emplace` and `get_or_compute` move
+    // their entries to the front as `policy` decides, a `put` always does.
+    void set_promotion( const promotion_policy &policy ) noexcept
+    {
+        _promotion = policy;
+    }
+
+    const promotion_policy &promotion() const noexcept
+    {
+        return _promotion;
+    }
+
     iterator begin() const noexcept
     {
         return iterator( _list.begin() );
@@ -116,11 +452,317 @@ public:
     }
 
 private:
-    lru_list _list;
-    lru_map  _map;
-    size_t   _capacity;
+    static constexpr size_t BATCH_SIZE = 32;
+    static constexpr size_t TRIM_BATCH = 64;
+
+    // Evicts a batch of the entries over the capacity left by `resize`.
+    void trim()
+    {
+        for( size_t i = 0; i < TRIM_BATCH && _map.size() > _capacity; ++i )
+        {
+            evict();
+        }
+    }
+
+    // Points `_map` and the timers to the entries moved by `_list.reserve`.
+    void relink()
+    {
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.find( it->first )->second = it;
+            if( it->deadline != NEVER )
+            {
+                _wheel.update( it->timer, it );
+            }
+        }
+    }
+
+    template <class _PutT>
+    void put_impl( const key_type &key, _PutT &&value, time_point deadline )
+    {
+        trim();
+
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            update_at( it, std::forward<_PutT>( value ), deadline );
+            return;
+        }
+        insert_at( it, deadline, [&]() {
+            _list.emplace_front( key, std::forward<_PutT>( value ) );
+        } );
+    }
+
+    template <class _Make>
+    std::pair<iterator, bool> emplace_impl( const key_type &key, _Make &&make )
+    {
+        if( !_wheel.empty() )
+        {
+            expire( clock::now() );
+        }
+        trim();
+
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            if( !expired( *( it->second ) ) )
+            {
+                promote_hit( it->second );
+                return { iterator( it->second ), false };
+            }
+            unlink( it->second );
+        }
+        if( !insert_at( it, NEVER, make ) )
+        {
+            return { end(), false };
+        }
+        return { begin(), true };
+    }
+
+    template <class _PutT>
+    void update_at( typename lru_map::iterator it, _PutT &&value,
+                    time_point deadline )
+    {
+        auto &entry = *( it->second );
+        move_front( it->second );
+
+        size_t old_weight = _weigher( entry.first, entry.second );
+        entry.second      = std::forward<_PutT>( value );
+        size_t new_weight = _weigher( entry.first, entry.second );
+        _weight -= old_weight;
+        if( new_weight > _max_weight )
+        {
+            cancel_timer( entry );
+            _list.erase( it->second );
+            _map.erase( it );
+            return;
+        }
+        _weight += new_weight;
+        set_timer( it->second, deadline );
+        // the updated entry is in front, so it is never evicted here
+        while( _weight > _max_weight )
+        {
+            evict();
+        }
+    }
+
+    // `it` is a just added `_map` element, `make` adds its entry to the
+    // front of `_list`. Returns `false` if the entry is too heavy to keep or
+    // the capacity is 0.
+    template <class _Make>
+    bool insert_at( typename lru_map::iterator it, time_point deadline,
+                    _Make &&make )
+    {
+        // a slab of capacity 0 has no room, and nothing is cached anyway
+        if( _capacity == 0 )
+        {
+            _map.erase( it );
+            return false;
+        }
+        // preallocated storage needs room for the new entry, otherwise
+        // nothing is evicted for an entry which fails to be made
+        if constexpr( _Storage::preallocated )
+        {
+            if( _map.size() > _capacity && !_list.empty() )
+            {
+                evict();
+            }
+        }
+        try
+        {
+            make();
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        it->second          = _list.begin();
+        _list.front().moved = ++_moves;
+
+        const kv_pair &entry  = _list.front();
+        size_t         weight = _weigher( entry.first, entry.second );
+        if( weight > _max_weight )
+        {
+            _list.pop_front();
+            _map.erase( it );
+            return false;
+        }
+        if constexpr( !_Storage::preallocated )
+        {
+            // the capacity is at least 1, so the new entry is not the last
+            if( _map.size() > _capacity )
+            {
+                evict();
+            }
+        }
+        // the new entry is the last one only when the others are gone
+        while( weight > _max_weight - _weight )
+        {
+            evict();
+        }
+        try
+        {
+            set_timer( _list.begin(), deadline );
+        }
+        catch( ... )
+        {
+            _list.pop_front();
+            _map.erase( it );
+            throw;
+        }
+        _weight += weight;
+        return true;
+    }
+
+    void evict()
+    {
+        entry &entry = _list.back();
+        cancel_timer( entry );
+        _weight -= _weigher( entry.first, entry.second );
+        _map.erase( entry.first );
+        _list.pop_back();
+    }
+
+    // Removes the entries which expire by `now`.
+    void expire( time_point now )
+    {
+        _wheel.advance( wheel_ticks( now ),
+                        [this]( typename lru_list::iterator pos ) {
+                            _weight -= _weigher( pos->first, pos->second );
+                            _map.erase( pos->first );
+                            _list.erase( pos );
+                        } );
+    }
+
+    // Schedules a new timer first, so the entry keeps its timer on failure.
+    void set_timer( typename lru_list::iterator pos, time_point deadline )
+    {
+        if( deadline == NEVER )
+        {
+            cancel_timer( *pos );
+            return;
+        }
+        auto timer = _wheel.schedule( wheel_deadline_ticks( deadline ), pos );
+        cancel_timer( *pos );
+        pos->deadline = deadline;
+        pos->timer    = timer;
+    }
+
+    void cancel_timer( entry &entry ) noexcept
+    {
+        if( entry.deadline != NEVER )
+        {
+            _wheel.cancel( entry.timer );
+            entry.deadline = NEVER;
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        trim();
+
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        if( expired( *( it->second ) ) )
+        {
+            erase_at( it );
+            return iterator( _list.end() );
+        }
+        promote_hit( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool contains_impl( const _K &key ) const
+    {
+        auto it = index_find<_Index>( _map, key );
+        return it != _map.end() && !expired( *( it->second ) );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        erase_at( it );
+        return true;
+    }
+
+    void erase_at( typename lru_map::iterator it )
+    {
+        unlink( it->second );
+        _map.erase( it );
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename lru_list::iterator pos )
+    {
+        cancel_timer( *pos );
+        _weight -= _weigher( pos->first, pos->second );
+        _list.erase( pos );
+    }
+
+    static bool expired( const entry &entry )
+    {
+        return entry.deadline != NEVER && entry.deadline <= clock::now();
+    }
+
+    void move_front( typename lru_list::iterator pos )
+    {
+        _list.splice( _list.begin(), _list, pos );
+        pos->moved = ++_moves;
+    }
+
+    // Moves a hit entry to the front if `_promotion` lets it.
+    void promote_hit( typename lru_list::iterator pos )
+    {
+        if( _promotion.promotes( _moves - pos->moved ) )
+        {
+            move_front( pos );
+        }
+    }
+
+    lru_list         _list;
+    lru_map          _map;
+    size_t           _capacity;
+    size_t           _weight;
+    size_t           _max_weight;
+    uint64_t         _moves;
+    weigher          _weigher;
+    promotion_policy _promotion;
+    lru_wheel        _wheel;
 };
 
+// LRU eviction for `basic_cache`, entries may be kept in any storage.
+template <class _Weigher = unit_weigher,
+          class _Clock   = std::chrono::steady_clock>
+struct lru_eviction
+{
+    static constexpr bool storage_aware = true;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = lru_cache_impl<_Key, _Tp, _Storage, _Index, _Hash,
+                                      _KeyEqual, _Weigher, _Clock>;
+};
+
+template <class _Key, class _Tp, class _Storage = list_storage,
+          class _Index = std_index, class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>,
+          class _Weigher  = unit_weigher,
+          class _Clock    = std::chrono::steady_clock>
+using lru_cache = basic_cache<_Key, _Tp, lru_eviction<_Weigher, _Clock>,
+                              _Index, _Storage, no_sync, _Hash, _KeyEqual>;
+
 } // namespace cachew
 
 #endif // CACHEW_LRU_CACHE_HPP
@@ -0,0 +1,26 @@
+#ifndef CACHEW_PREFETCH_HPP
+#define CACHEW_PREFETCH_HPP
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <xmmintrin.h>
+#endif
+
+namespace cachew
+{
+
+// Hints the CPU to bring the cache line of `addr` in for a read, it's a no-op
+// on the compilers without a prefetch intrinsic.
+inline void prefetch( const void *addr ) noexcept
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+    __builtin_prefetch( addr );
+#elif defined( _MSC_VER )
+    _mm_prefetch( static_cast<const char *>( addr ), _MM_HINT_T0 );
+#else
+    (void)addr;
+#endif
+}
+
+} // namespace cachew
+
+#endif // CACHEW_PREFETCH_HPP
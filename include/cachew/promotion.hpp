@@ -0,0 +1,95 @@
+#ifndef CACHEW_PROMOTION_HPP
+#define CACHEW_PROMOTION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace cachew
+{
+
+// xorshift64 of the calling thread, the threads are seeded apart.
+inline uint64_t promotion_random() noexcept
+{
+    static std::atomic<uint64_t> seeds{ 0 };
+    thread_local uint64_t        state = []() {
+        // splitmix64 of the thread number
+        uint64_t z = ( seeds.fetch_add( 1, std::memory_order_relaxed ) + 1 ) *
+                     0x9e3779b97f4a7c15ULL;
+        z          = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        z          = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+        return ( z ^ ( z >> 31 ) ) | 1;
+    }();
+
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Decides whether a hit promotes its entry, e.g. splices it to the front of
+// the LRU list. Hot entries are near the front anyway, so skipping some of
+// their promotions saves the list traffic at the cost of a less exact order.
+//
+// The age of an entry is the number of promotions and additions since the
+// entry was last promoted or added, so an entry younger than `min_age` is
+// one of the `min_age` entries at the front.
+class promotion_policy
+{
+public:
+    // Every hit promotes.
+    promotion_policy() noexcept = default;
+
+    // A hit promotes with `probability`, and only if its entry is at least
+    // `min_age` old.
+    explicit promotion_policy( double   probability,
+                               uint64_t min_age = 0 ) noexcept
+        : _threshold( threshold( probability ) )
+        , _min_age( min_age )
+    {
+    }
+
+    double probability() const noexcept
+    {
+        return _threshold == ALWAYS
+                   ? 1.0
+                   : static_cast<double>( _threshold ) / TWO_POW_64;
+    }
+
+    uint64_t min_age() const noexcept
+    {
+        return _min_age;
+    }
+
+    // Returns `true` if a hit on an entry of `age` promotes it, the random
+    // number is drawn only for a probability below 1.
+    bool promotes( uint64_t age ) const noexcept
+    {
+        return age >= _min_age &&
+               ( _threshold == ALWAYS || promotion_random() < _threshold );
+    }
+
+private:
+    static constexpr uint64_t ALWAYS = std::numeric_limits<uint64_t>::max();
+    static constexpr double   TWO_POW_64 = 18446744073709551616.0;
+
+    static uint64_t threshold( double probability ) noexcept
+    {
+        if( !( probability < 1.0 ) )
+        {
+            return ALWAYS;
+        }
+        if( !( probability > 0.0 ) )
+        {
+            return 0;
+        }
+        return static_cast<uint64_t>( probability * TWO_POW_64 );
+    }
+
+    uint64_t _threshold = ALWAYS;
+    uint64_t _min_age   = 0;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_PROMOTION_HPP
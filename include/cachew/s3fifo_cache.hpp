@@ -0,0 +1,591 @@
+#ifndef CACHEW_S3FIFO_CACHE_HPP
+#define CACHEW_S3FIFO_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cachew
+{
+
+// S3-FIFO cache. New keys go to a small FIFO, about 10% of the capacity, and
+// the keys it pushes out which were not hit there go to a ghost FIFO of key
+// hashes as large as the main FIFO. Keys hit in the small FIFO, and keys
+// which come back while their hash is a ghost, go to the main FIFO, where a
+// key with hits is reinserted instead of evicted. A hit only increments a
+// 2-bit counter of the entry, entries are never relinked. The entries live
+// in a fixed array of slots and the queues are ring buffers of slot indices.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class s3fifo_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    // Hit counters stop at this value.
+    static constexpr std::uint8_t MAX_FREQUENCY = 3;
+
+    struct slot
+    {
+        std::optional<kv_pair> entry;
+        // position in the queue, the queue may hold stale indices of the
+        // slot from before it was freed
+        size_t       pos     = 0;
+        std::uint8_t freq    = 0;
+        bool         in_main = false;
+    };
+
+    using s3fifo_slots = std::vector<slot>;
+    using s3fifo_map   = typename _Index::template map_type<key_type, slot *,
+                                                          hasher, key_equal>;
+    // Positions of the key hashes in the ghost FIFO.
+    using ghost_map = typename _Index::template map_type<
+        std::size_t, size_t, default_hash<std::size_t>,
+        default_key_equal<std::size_t>>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename s3fifo_map::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second->entry->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second->entry->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // Ring buffer of `size_t`. Positions grow with every push, the value at
+    // position `p` lives at `p % capacity`.
+    struct fifo_ring
+    {
+        explicit fifo_ring( size_t capacity )
+            : values( std::max<size_t>( capacity, 1 ) )
+            , head( 0 )
+            , tail( 0 )
+        {
+        }
+
+        bool empty() const noexcept
+        {
+            return head == tail;
+        }
+        bool full() const noexcept
+        {
+            return tail - head == values.size();
+        }
+        size_t size() const noexcept
+        {
+            return tail - head;
+        }
+        size_t &at( size_t pos ) noexcept
+        {
+            return values[pos % values.size()];
+        }
+        // Returns the position of the pushed value.
+        size_t push( size_t value ) noexcept
+        {
+            at( tail ) = value;
+            return tail++;
+        }
+        void pop() noexcept
+        {
+            ++head;
+        }
+        void clear() noexcept
+        {
+            head = 0;
+            tail = 0;
+        }
+
+        std::vector<size_t> values;
+        size_t              head;
+        size_t              tail;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const s3fifo_cache &lhs, const s3fifo_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // The small FIFO takes 10% of the capacity, at least one entry.
+    explicit s3fifo_cache( size_t capacity )
+        : _slots( capacity )
+        , _small( 2 * capacity )
+        , _main( 2 * capacity )
+        , _ghost( capacity - small_share( capacity ) )
+        , _used( 0 )
+        , _capacity( capacity )
+        , _small_capacity( small_share( capacity ) )
+        , _ghost_capacity( capacity - _small_capacity )
+        , _small_size( 0 )
+    {
+        // `release` must not allocate
+        _free.reserve( capacity );
+        _map.reserve( capacity );
+    }
+
+    s3fifo_cache( const s3fifo_cache &other )
+        : _slots( other._slots )
+        , _free( other._free )
+        , _small( other._small )
+        , _main( other._main )
+        , _ghost( other._ghost )
+        , _ghost_map( other._ghost_map )
+        , _used( other._used )
+        , _capacity( other._capacity )
+        , _small_capacity( other._small_capacity )
+        , _ghost_capacity( other._ghost_capacity )
+        , _small_size( other._small_size )
+        , _hash( other._hash )
+    {
+        _free.reserve( _capacity );
+
+        // `_map` refers to the slots of `other` and has to be rebuilt
+        _map.reserve( _capacity );
+        for( auto &s : _slots )
+        {
+            if( s.entry )
+            {
+                _map.emplace( s.entry->first, &s );
+            }
+        }
+    }
+
+    // `other` is left as an empty cache of capacity 0.
+    s3fifo_cache( s3fifo_cache &&other )
+        : s3fifo_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    s3fifo_cache &operator=( const s3fifo_cache &other )
+    {
+        if( this != &other )
+        {
+            s3fifo_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    s3fifo_cache &operator=( s3fifo_cache &&other )
+    {
+        if( this != &other )
+        {
+            // `_map` refers to the slots, they keep their place in the moved
+            // vector
+            _slots          = std::move( other._slots );
+            _free           = std::move( other._free );
+            _map            = std::move( other._map );
+            _small          = std::move( other._small );
+            _main           = std::move( other._main );
+            _ghost          = std::move( other._ghost );
+            _ghost_map      = std::move( other._ghost_map );
+            _used           = std::exchange( other._used, 0 );
+            _capacity       = std::exchange( other._capacity, 0 );
+            _small_capacity = std::exchange( other._small_capacity, 0 );
+            _ghost_capacity = std::exchange( other._ghost_capacity, 0 );
+            _small_size     = std::exchange( other._small_size, 0 );
+            _hash           = std::move( other._hash );
+
+            // the rings are never read at capacity 0
+            other._slots.clear();
+            other._free.clear();
+            other._map.clear();
+            other._small.clear();
+            other._main.clear();
+            other._ghost.clear();
+            other._ghost_map.clear();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( size_t i = 0; i < _used; ++i )
+        {
+            slot &s = _slots[i];
+            if( !s.entry )
+            {
+                continue;
+            }
+            const kv_pair &entry = *( s.entry );
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( s.entry->first );
+                release( s );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries and the ghost hashes.
+    void clear() noexcept
+    {
+        _map.clear();
+        for( size_t i = 0; i < _used; ++i )
+        {
+            _slots[i] = slot();
+        }
+        _free.clear();
+        _small.clear();
+        _main.clear();
+        _ghost.clear();
+        _ghost_map.clear();
+        _used       = 0;
+        _small_size = 0;
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        auto it = _map.find( key );
+        if( it != _map.end() )
+        {
+            it->second->entry->second = std::forward<_PutT>( value );
+            touch( *( it->second ) );
+            return;
+        }
+        if( _capacity == 0 )
+        {
+            return;
+        }
+
+        bool to_main = false;
+        auto ghost   = _ghost_map.find( _hash( key ) );
+        if( ghost != _ghost_map.end() )
+        {
+            // its ring position becomes stale
+            _ghost_map.erase( ghost );
+            to_main = true;
+        }
+
+        size_t index = acquire();
+        slot  &s     = _slots[index];
+        try
+        {
+            s.entry.emplace( key, std::forward<_PutT>( value ) );
+            _map.emplace( key, &s );
+        }
+        catch( ... )
+        {
+            s.entry.reset();
+            _free.push_back( index );
+            throw;
+        }
+        s.freq = 0;
+        push( index, to_main );
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t small_capacity() const noexcept
+    {
+        return _small_capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    // Number of entries in the small FIFO.
+    size_t small_size() const noexcept
+    {
+        return _small_size;
+    }
+
+    // Number of key hashes in the ghost FIFO.
+    size_t ghost_size() const noexcept
+    {
+        return _ghost_map.size();
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator( _map.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _map.end() );
+    }
+
+private:
+    static size_t small_share( size_t capacity ) noexcept
+    {
+        return std::min( capacity, std::max<size_t>( capacity / 10, 1 ) );
+    }
+
+    static void touch( slot &s ) noexcept
+    {
+        if( s.freq < MAX_FREQUENCY )
+        {
+            ++s.freq;
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return end();
+        }
+        touch( *( it->second ) );
+
+        return iterator( it );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        slot &s = *( it->second );
+        _map.erase( it );
+        release( s );
+        return true;
+    }
+
+    // Returns the index of an empty slot, evicting an entry if the cache is
+    // full.
+    size_t acquire()
+    {
+        if( !_free.empty() )
+        {
+            size_t index = _free.back();
+            _free.pop_back();
+            return index;
+        }
+        if( _used < _capacity )
+        {
+            return _used++;
+        }
+        return evict();
+    }
+
+    // The small FIFO is evicted while it is over its share or the main one
+    // is empty, a key hit there moves to the main FIFO and the others leave
+    // their hash in the ghost FIFO. A main key with hits is reinserted with
+    // one hit less.
+    size_t evict()
+    {
+        for( ;; )
+        {
+            bool  small = _small_size > 0 && ( _small_size >= _small_capacity ||
+                                               _small_size == _map.size() );
+            auto &queue = small ? _small : _main;
+            size_t index = queue.at( queue.head );
+            slot  &s     = _slots[index];
+            if( !valid( s, queue.head, !small ) )
+            {
+                queue.pop();
+                continue;
+            }
+            if( small )
+            {
+                if( s.freq > 0 )
+                {
+                    queue.pop();
+                    --_small_size;
+                    s.freq = 0;
+                    push( index, true );
+                    continue;
+                }
+                // before anything changes, it may throw
+                remember( _hash( s.entry->first ) );
+                queue.pop();
+                --_small_size;
+            }
+            else
+            {
+                queue.pop();
+                if( s.freq > 0 )
+                {
+                    --s.freq;
+                    push( index, true );
+                    continue;
+                }
+            }
+            _map.erase( s.entry->first );
+            s.entry.reset();
+            return index;
+        }
+    }
+
+    // A queue value at `pos` with the index of `s` is stale if the slot was
+    // freed or moved since.
+    static bool valid( const slot &s, size_t pos, bool in_main ) noexcept
+    {
+        return s.entry && s.in_main == in_main && s.pos == pos;
+    }
+
+    void push( size_t index, bool to_main ) noexcept
+    {
+        auto &queue = to_main ? _main : _small;
+        if( queue.full() )
+        {
+            compact( queue, to_main );
+        }
+        slot &s   = _slots[index];
+        s.in_main = to_main;
+        s.pos     = queue.push( index );
+        if( !to_main )
+        {
+            ++_small_size;
+        }
+    }
+
+    // Drops the stale indices of `queue`. It holds twice as many values as
+    // there are slots, so this happens at most once in `capacity` pushes.
+    void compact( fifo_ring &queue, bool in_main ) noexcept
+    {
+        size_t write = queue.head;
+        for( size_t read = queue.head; read != queue.tail; ++read )
+        {
+            size_t index = queue.at( read );
+            slot  &s     = _slots[index];
+            if( valid( s, read, in_main ) )
+            {
+                queue.at( write ) = index;
+                s.pos             = write++;
+            }
+        }
+        queue.tail = write;
+    }
+
+    void remember( std::size_t hash )
+    {
+        if( _ghost_capacity == 0 )
+        {
+            return;
+        }
+        if( _ghost.full() )
+        {
+            auto it = _ghost_map.find( _ghost.at( _ghost.head ) );
+            if( it != _ghost_map.end() && it->second == _ghost.head )
+            {
+                _ghost_map.erase( it );
+            }
+            _ghost.pop();
+        }
+        _ghost_map.try_emplace( hash ).first->second = _ghost.push( hash );
+    }
+
+    void release( slot &s ) noexcept
+    {
+        if( !s.in_main )
+        {
+            --_small_size;
+        }
+        s.entry.reset();
+        s.freq = 0;
+        _free.push_back( static_cast<size_t>( &s - _slots.data() ) );
+    }
+
+    s3fifo_slots        _slots;
+    std::vector<size_t> _free;
+    s3fifo_map          _map;
+    fifo_ring           _small;
+    fifo_ring           _main;
+    fifo_ring           _ghost;
+    ghost_map           _ghost_map;
+    size_t              _used;
+    size_t              _capacity;
+    size_t              _small_capacity;
+    size_t              _ghost_capacity;
+    size_t              _small_size;
+    hasher              _hash;
+};
+
+// S3-FIFO eviction for `basic_cache`.
+struct s3fifo_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = s3fifo_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_S3FIFO_CACHE_HPP
@@ -0,0 +1,330 @@
+#ifndef CACHEW_SIEVE_CACHE_HPP
+#define CACHEW_SIEVE_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// SIEVE cache. Entries stay in insertion order, a hit only marks the entry
+// visited. Eviction moves a hand from the oldest entry towards the newest,
+// clearing the visited marks, and evicts the first entry which was not
+// visited. The hand keeps its place between evictions, so new entries
+// which are not hit are evicted soon while the older ones hit are kept.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class sieve_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        bool visited = false;
+    };
+
+    // Entries from the newest.
+    using sieve_list = std::list<entry>;
+    using sieve_map  = typename _Index::template map_type<
+        key_type, typename sieve_list::iterator, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename sieve_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const sieve_cache &lhs, const sieve_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    explicit sieve_cache( size_t capacity )
+        : _hand( _list.end() )
+        , _capacity( capacity )
+    {
+    }
+
+    sieve_cache( const sieve_cache &other )
+        : _list( other._list )
+        , _hand( _list.end() )
+        , _capacity( other._capacity )
+    {
+        // `_map` and `_hand` refer to the nodes of `other` and have to be
+        // rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+        }
+        if( other._hand != other._list.end() )
+        {
+            auto hand = typename sieve_list::const_iterator( other._hand );
+            _hand     = std::next( _list.begin(),
+                                   std::distance( other._list.begin(), hand ) );
+        }
+    }
+
+    sieve_cache( sieve_cache &&other )
+        : sieve_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    sieve_cache &operator=( const sieve_cache &other )
+    {
+        if( this != &other )
+        {
+            sieve_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    sieve_cache &operator=( sieve_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            auto hand      = other._hand;
+            bool hand_tail = hand == other._list.end();
+
+            _list     = std::move( other._list );
+            _map      = std::move( other._map );
+            _hand     = hand_tail ? _list.end() : hand;
+            _capacity = other._capacity;
+
+            other._map.clear();
+            other._list.clear();
+            other._hand = other._list.end();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _hand = _list.end();
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            it->second->second  = std::forward<_PutT>( value );
+            it->second->visited = true;
+            return;
+        }
+
+        // the new entry is made before anything is evicted for it
+        sieve_list pending;
+        try
+        {
+            pending.emplace_back( key, std::forward<_PutT>( value ) );
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        if( _list.size() >= _capacity )
+        {
+            evict();
+        }
+        _list.splice( _list.begin(), pending );
+        it->second = _list.begin();
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    // Newest entries go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    // The hand starts from the oldest entry if it is not set and wraps around
+    // to it after the newest one.
+    void evict() noexcept
+    {
+        auto pos = _hand == _list.end() ? std::prev( _list.end() ) : _hand;
+        while( pos->visited )
+        {
+            pos->visited = false;
+            pos = pos == _list.begin() ? std::prev( _list.end() )
+                                       : std::prev( pos );
+        }
+        _map.erase( pos->first );
+        _hand = pos;
+        unlink( pos );
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        it->second->visited = true;
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Removes the entry from `_list` only, the hand moves to the next newer
+    // entry.
+    void unlink( typename sieve_list::iterator pos ) noexcept
+    {
+        if( pos == _hand )
+        {
+            _hand = pos == _list.begin() ? _list.end() : std::prev( pos );
+        }
+        _list.erase( pos );
+    }
+
+    sieve_list                    _list;
+    sieve_map                     _map;
+    typename sieve_list::iterator _hand;
+    size_t                        _capacity;
+};
+
+// SIEVE eviction for `basic_cache`.
+struct sieve_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = sieve_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_SIEVE_CACHE_HPP
@@ -0,0 +1,460 @@
+#ifndef CACHEW_SLAB_LIST_HPP
+#define CACHEW_SLAB_LIST_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace cachew
+{
+
+// Doubly linked list which keeps all nodes in one preallocated array. Nodes
+// are linked by 32-bit indices and released nodes are recycled through a free
+// list, so the list never allocates after construction.
+template <class _Tp>
+class slab_list
+{
+public:
+    using value_type = _Tp;
+    using size_type  = std::size_t;
+    using index_type = std::uint32_t;
+
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+private:
+    struct node
+    {
+        using storage_type =
+            typename std::aligned_storage<sizeof( value_type ),
+                                          alignof( value_type )>::type;
+
+        inline value_type &value() noexcept
+        {
+            return *std::launder( reinterpret_cast<value_type *>( &storage ) );
+        }
+
+        inline const value_type &value() const noexcept
+        {
+            return *std::launder(
+                reinterpret_cast<const value_type *>( &storage ) );
+        }
+
+        index_type   prev;
+        index_type   next;
+        storage_type storage;
+    };
+
+    template <bool _Const>
+    class basic_iterator
+    {
+        friend class slab_list;
+
+        using node_ptr = std::conditional_t<_Const, const node *, node *>;
+
+    public:
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = typename slab_list::value_type;
+        using iterator_category = std::forward_iterator_tag;
+
+        using pointer   = std::conditional_t<_Const, const _Tp *, _Tp *>;
+        using reference = std::conditional_t<_Const, const _Tp &, _Tp &>;
+
+        basic_iterator() = default;
+
+        template <bool _OtherConst,
+                  class = std::enable_if_t<_Const && !_OtherConst>>
+        basic_iterator( const basic_iterator<_OtherConst> &it )
+            : _nodes( it._nodes )
+            , _idx( it._idx )
+        {
+        }
+
+        bool operator==( const basic_iterator &it ) const
+        {
+            return _idx == it._idx;
+        }
+
+        bool operator!=( const basic_iterator &it ) const
+        {
+            return _idx != it._idx;
+        }
+
+        basic_iterator &operator++()
+        {
+            _idx = _nodes[_idx].next;
+            return *this;
+        }
+
+        basic_iterator operator++( int )
+        {
+            basic_iterator res( *this );
+            ++( *this );
+            return res;
+        }
+
+        reference operator*() const
+        {
+            return _nodes[_idx].value();
+        }
+
+        pointer operator->() const
+        {
+            return &( _nodes[_idx].value() );
+        }
+
+    private:
+        basic_iterator( node_ptr nodes, index_type idx )
+            : _nodes( nodes )
+            , _idx( idx )
+        {
+        }
+
+        node_ptr   _nodes = nullptr;
+        index_type _idx   = npos;
+    };
+
+public:
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    explicit slab_list( size_type capacity )
+        : _nodes( nullptr )
+        , _capacity( 0 )
+        , _size( 0 )
+        , _used( 0 )
+        , _head( npos )
+        , _tail( npos )
+        , _free( npos )
+    {
+        if( capacity >= npos )
+        {
+            throw std::length_error( "slab_list capacity is too big" );
+        }
+        _nodes.reset( new node[capacity] );
+        _capacity = static_cast<index_type>( capacity );
+    }
+
+    slab_list( const slab_list &other )
+        : slab_list( other._capacity )
+    {
+        for( const auto &val : other )
+        {
+            emplace_back( val );
+        }
+    }
+
+    slab_list( slab_list &&other ) noexcept
+        : _nodes( std::move( other._nodes ) )
+        , _capacity( std::exchange( other._capacity, 0 ) )
+        , _size( std::exchange( other._size, 0 ) )
+        , _used( std::exchange( other._used, 0 ) )
+        , _head( std::exchange( other._head, npos ) )
+        , _tail( std::exchange( other._tail, npos ) )
+        , _free( std::exchange( other._free, npos ) )
+    {
+    }
+
+    slab_list &operator=( const slab_list &other )
+    {
+        if( this != &other )
+        {
+            slab_list tmp( other );
+            swap( tmp );
+        }
+        return *this;
+    }
+
+    slab_list &operator=( slab_list &&other ) noexcept
+    {
+        if( this != &other )
+        {
+            clear();
+            slab_list tmp( std::move( other ) );
+            swap( tmp );
+        }
+        return *this;
+    }
+
+    ~slab_list()
+    {
+        clear();
+    }
+
+    void swap( slab_list &other ) noexcept
+    {
+        std::swap( _nodes, other._nodes );
+        std::swap( _capacity, other._capacity );
+        std::swap( _size, other._size );
+        std::swap( _used, other._used );
+        std::swap( _head, other._head );
+        std::swap( _tail, other._tail );
+        std::swap( _free, other._free );
+    }
+
+    template <class... _Args>
+    value_type &emplace_front( _Args &&... args )
+    {
+        index_type idx = construct( std::forward<_Args>( args )... );
+        link_before( _head, idx );
+        return _nodes[idx].value();
+    }
+
+    template <class... _Args>
+    value_type &emplace_back( _Args &&... args )
+    {
+        index_type idx = construct( std::forward<_Args>( args )... );
+        link_before( npos, idx );
+        return _nodes[idx].value();
+    }
+
+    void pop_front()
+    {
+        assert( !empty() );
+        destroy( _head );
+    }
+
+    void pop_back()
+    {
+        assert( !empty() );
+        destroy( _tail );
+    }
+
+    iterator erase( const_iterator pos )
+    {
+        index_type next = _nodes[pos._idx].next;
+        destroy( pos._idx );
+        return iterator( _nodes.get(), next );
+    }
+
+    // Only splicing inside the same list is supported, the nodes of
+    // different slabs are not interchangeable.
+    void splice( const_iterator pos, slab_list &other, const_iterator it )
+    {
+        assert( &other == this );
+        (void)other;
+
+        if( pos._idx == it._idx )
+        {
+            return;
+        }
+        unlink( it._idx );
+        link_before( pos._idx, it._idx );
+    }
+
+    void clear() noexcept
+    {
+        while( _head != npos )
+        {
+            destroy( _head );
+        }
+        _used = 0;
+        _free = npos;
+    }
+
+    value_type &front()
+    {
+        return _nodes[_head].value();
+    }
+
+    const value_type &front() const
+    {
+        return _nodes[_head].value();
+    }
+
+    value_type &back()
+    {
+        return _nodes[_tail].value();
+    }
+
+    const value_type &back() const
+    {
+        return _nodes[_tail].value();
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator( _nodes.get(), _head );
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator( _nodes.get(), _head );
+    }
+
+    iterator end() noexcept
+    {
+        return iterator( _nodes.get(), npos );
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator( _nodes.get(), npos );
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return _size;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    // Grows the slab to `capacity` nodes. Nodes keep their indices, but all
+    // iterators are invalidated as the nodes are moved to a new array.
+    void reserve( size_type capacity )
+    {
+        if( capacity <= _capacity )
+        {
+            return;
+        }
+        if( capacity >= npos )
+        {
+            throw std::length_error( "slab_list capacity is too big" );
+        }
+
+        std::unique_ptr<node[]> nodes( new node[capacity] );
+        index_type              moved = _head;
+        try
+        {
+            for( ; moved != npos; moved = _nodes[moved].next )
+            {
+                ::new( static_cast<void *>( &nodes[moved].storage ) )
+                    value_type(
+                        std::move_if_noexcept( _nodes[moved].value() ) );
+            }
+        }
+        catch( ... )
+        {
+            for( index_type idx = _head; idx != moved; idx = _nodes[idx].next )
+            {
+                nodes[idx].value().~value_type();
+            }
+            throw;
+        }
+
+        for( index_type idx = 0; idx < _used; ++idx )
+        {
+            nodes[idx].prev = _nodes[idx].prev;
+            nodes[idx].next = _nodes[idx].next;
+        }
+        for( index_type idx = _head; idx != npos; idx = _nodes[idx].next )
+        {
+            _nodes[idx].value().~value_type();
+        }
+        _nodes    = std::move( nodes );
+        _capacity = static_cast<index_type>( capacity );
+    }
+
+private:
+    template <class... _Args>
+    index_type construct( _Args &&... args )
+    {
+        index_type idx;
+        if( _free != npos )
+        {
+            idx   = _free;
+            _free = _nodes[idx].next;
+        }
+        else if( _used < _capacity )
+        {
+            idx = _used++;
+        }
+        else
+        {
+            throw std::length_error( "slab_list is full" );
+        }
+
+        try
+        {
+            ::new( static_cast<void *>( &_nodes[idx].storage ) )
+                value_type( std::forward<_Args>( args )... );
+        }
+        catch( ... )
+        {
+            _nodes[idx].next = _free;
+            _free            = idx;
+            throw;
+        }
+        return idx;
+    }
+
+    void destroy( index_type idx ) noexcept
+    {
+        unlink( idx );
+        _nodes[idx].value().~value_type();
+        _nodes[idx].next = _free;
+        _free            = idx;
+    }
+
+    void link_before( index_type pos, index_type idx ) noexcept
+    {
+        node &n = _nodes[idx];
+        n.next  = pos;
+        if( pos == npos )
+        {
+            n.prev = _tail;
+            _tail  = idx;
+        }
+        else
+        {
+            n.prev           = _nodes[pos].prev;
+            _nodes[pos].prev = idx;
+        }
+        if( n.prev == npos )
+        {
+            _head = idx;
+        }
+        else
+        {
+            _nodes[n.prev].next = idx;
+        }
+        ++_size;
+    }
+
+    void unlink( index_type idx ) noexcept
+    {
+        node &n = _nodes[idx];
+        if( n.prev == npos )
+        {
+            _head = n.next;
+        }
+        else
+        {
+            _nodes[n.prev].next = n.next;
+        }
+        if( n.next == npos )
+        {
+            _tail = n.prev;
+        }
+        else
+        {
+            _nodes[n.next].prev = n.prev;
+        }
+        --_size;
+    }
+
+    std::unique_ptr<node[]> _nodes;
+    index_type              _capacity;
+    index_type              _size;
+    index_type              _used;
+    index_type              _head;
+    index_type              _tail;
+    index_type              _free;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_SLAB_LIST_HPP
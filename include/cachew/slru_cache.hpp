@@ -0,0 +1,372 @@
+#ifndef CACHEW_SLRU_CACHE_HPP
+#define CACHEW_SLRU_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// Segmented LRU cache. New entries go to the probationary segment and are
+// promoted to the protected one on a hit, the least recently used protected
+// entry is demoted back to probation when the protected segment is full.
+// Entries are evicted from probation, so keys seen once, like a scan, do not
+// push out the keys which are hit.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class slru_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        bool is_protected = false;
+    };
+
+    // Both segments share one list: the protected entries are followed by the
+    // probationary ones, each segment from the most recently used entry.
+    using slru_list = std::list<entry>;
+    using slru_map  = typename _Index::template map_type<
+        key_type, typename slru_list::iterator, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename slru_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const slru_cache &lhs, const slru_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // The protected segment takes 80% of the capacity.
+    explicit slru_cache( size_t capacity )
+        : slru_cache( capacity, capacity - capacity / 5 )
+    {
+    }
+
+    // `protected_capacity` is at most `capacity`.
+    slru_cache( size_t capacity, size_t protected_capacity )
+        : _probation( _list.end() )
+        , _capacity( capacity )
+        , _protected_capacity( std::min( protected_capacity, capacity ) )
+        , _protected_size( 0 )
+    {
+    }
+
+    slru_cache( const slru_cache &other )
+        : _list( other._list )
+        , _probation( _list.end() )
+        , _capacity( other._capacity )
+        , _protected_capacity( other._protected_capacity )
+        , _protected_size( other._protected_size )
+    {
+        // `_map` and `_probation` refer to the nodes of `other` and have to be
+        // rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+        }
+        _probation = std::find_if( _list.begin(), _list.end(),
+                                   []( const entry &e ) {
+                                       return !e.is_protected;
+                                   } );
+    }
+
+    slru_cache( slru_cache &&other )
+        : slru_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    slru_cache &operator=( const slru_cache &other )
+    {
+        if( this != &other )
+        {
+            slru_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    slru_cache &operator=( slru_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            auto probation      = other._probation;
+            bool probation_tail = probation == other._list.end();
+
+            _list               = std::move( other._list );
+            _map                = std::move( other._map );
+            _probation          = probation_tail ? _list.end() : probation;
+            _capacity           = other._capacity;
+            _protected_capacity = other._protected_capacity;
+            _protected_size     = std::exchange( other._protected_size, 0 );
+
+            other._list.clear();
+            other._map.clear();
+            other._probation = other._list.end();
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _probation      = _list.end();
+        _protected_size = 0;
+    }
+
+    // An update is a hit, so it promotes the entry as `get` does.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            it->second->second = std::forward<_PutT>( value );
+            promote( it->second );
+            return;
+        }
+        try
+        {
+            _probation = _list.emplace( _probation, key,
+                                        std::forward<_PutT>( value ) );
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        it->second = _probation;
+
+        if( _map.size() > _capacity )
+        {
+            evict();
+        }
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t protected_capacity() const noexcept
+    {
+        return _protected_capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    size_t protected_size() const noexcept
+    {
+        return _protected_size;
+    }
+
+    // Protected entries go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    // Moves a hit entry to the front of the protected segment.
+    void promote( typename slru_list::iterator pos )
+    {
+        if( pos == _probation )
+        {
+            ++_probation;
+        }
+        _list.splice( _list.begin(), _list, pos );
+        if( pos->is_protected )
+        {
+            return;
+        }
+        pos->is_protected = true;
+        if( ++_protected_size > _protected_capacity )
+        {
+            // the last protected entry becomes the first probationary one
+            --_probation;
+            _probation->is_protected = false;
+            --_protected_size;
+        }
+    }
+
+    // Evicts the last probationary entry, or the last protected one if the
+    // just added entry is the only one in probation.
+    void evict()
+    {
+        auto victim = std::prev( _list.end() );
+        if( victim == _probation && _probation != _list.begin() )
+        {
+            victim = std::prev( _probation );
+        }
+        _map.erase( victim->first );
+        unlink( victim );
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        promote( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename slru_list::iterator pos ) noexcept
+    {
+        if( pos == _probation )
+        {
+            ++_probation;
+        }
+        if( pos->is_protected )
+        {
+            --_protected_size;
+        }
+        _list.erase( pos );
+    }
+
+    slru_list                    _list;
+    slru_map                     _map;
+    typename slru_list::iterator _probation;
+    size_t                       _capacity;
+    size_t                       _protected_capacity;
+    size_t                       _protected_size;
+};
+
+// Segmented LRU eviction for `basic_cache`.
+struct slru_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = slru_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_SLRU_CACHE_HPP
@@ -0,0 +1,44 @@
+#ifndef CACHEW_STORAGE_HPP
+#define CACHEW_STORAGE_HPP
+
+#include "slab_list.hpp"
+
+#include <list>
+
+namespace cachew
+{
+
+// Entries are kept in `std::list`, every entry is a separate allocation.
+struct list_storage
+{
+    static constexpr bool preallocated = false;
+
+    template <class _Tp>
+    using list_type = std::list<_Tp>;
+
+    template <class _Tp>
+    static list_type<_Tp> make( size_t /*capacity*/ ) noexcept
+    {
+        return list_type<_Tp>();
+    }
+};
+
+// Entries are kept in a `slab_list` sized from the cache capacity, no
+// allocations are made for entries after the cache construction.
+struct slab_storage
+{
+    static constexpr bool preallocated = true;
+
+    template <class _Tp>
+    using list_type = slab_list<_Tp>;
+
+    template <class _Tp>
+    static list_type<_Tp> make( size_t capacity )
+    {
+        return list_type<_Tp>( capacity );
+    }
+};
+
+} // namespace cachew
+
+#endif // CACHEW_STORAGE_HPP
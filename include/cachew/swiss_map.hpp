@@ -0,0 +1,730 @@
+#ifndef CACHEW_SWISS_MAP_HPP
+#define CACHEW_SWISS_MAP_HPP
+
+// https://abseil.io/about/design/swisstables
+
+#include "hash.hpp"
+#include "prefetch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) ||                               \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define CACHEW_SWISS_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace cachew
+{
+
+namespace swiss_detail
+{
+
+using ctrl_t = std::int8_t;
+
+static constexpr ctrl_t      EMPTY       = -128; // 0b10000000
+static constexpr ctrl_t      DELETED     = -2;   // 0b11111110
+static constexpr std::size_t GROUP_WIDTH = 16;
+
+inline bool is_full( ctrl_t c ) noexcept
+{
+    return c >= 0;
+}
+
+// Spreads the bits of `std::hash`, which is identity for integers in the
+// major standard libraries, so both the group index and the tag are usable.
+inline std::size_t mix( std::size_t hash ) noexcept
+{
+    auto h = static_cast<std::uint64_t>( hash );
+    h ^= h >> 33U;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33U;
+    return static_cast<std::size_t>( h );
+}
+
+inline std::size_t h1( std::size_t hash ) noexcept
+{
+    return hash >> 7U;
+}
+
+inline ctrl_t h2( std::size_t hash ) noexcept
+{
+    return static_cast<ctrl_t>( hash & 0x7FU );
+}
+
+// One bit per slot of a control group.
+class bitmask
+{
+public:
+    explicit bitmask( std::uint32_t mask ) noexcept
+        : _mask( mask )
+    {
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return _mask != 0;
+    }
+
+    std::size_t lowest() const noexcept
+    {
+#if defined( __GNUC__ ) || defined( __clang__ )
+        return static_cast<std::size_t>( __builtin_ctz( _mask ) );
+#else
+        std::size_t   res  = 0;
+        std::uint32_t mask = _mask;
+        while( ( mask & 1U ) == 0 )
+        {
+            mask >>= 1U;
+            ++res;
+        }
+        return res;
+#endif
+    }
+
+    void clear_lowest() noexcept
+    {
+        _mask &= _mask - 1;
+    }
+
+private:
+    std::uint32_t _mask;
+};
+
+// 16 control bytes which are probed together: with SSE2 a single compare
+// answers "which slots may hold this key" for the whole group.
+class group
+{
+public:
+    explicit group( const ctrl_t *pos ) noexcept
+    {
+#ifdef CACHEW_SWISS_MAP_SSE2
+        _ctrl = _mm_loadu_si128( reinterpret_cast<const __m128i *>( pos ) );
+#else
+        std::memcpy( _ctrl, pos, GROUP_WIDTH );
+#endif
+    }
+
+    bitmask match( ctrl_t tag ) const noexcept
+    {
+#ifdef CACHEW_SWISS_MAP_SSE2
+        return bitmask( static_cast<std::uint32_t>( _mm_movemask_epi8(
+            _mm_cmpeq_epi8( _mm_set1_epi8( tag ), _ctrl ) ) ) );
+#else
+        std::uint32_t mask = 0;
+        for( std::size_t i = 0; i < GROUP_WIDTH; ++i )
+        {
+            mask |= static_cast<std::uint32_t>( _ctrl[i] == tag ) << i;
+        }
+        return bitmask( mask );
+#endif
+    }
+
+    bitmask match_empty() const noexcept
+    {
+        return match( EMPTY );
+    }
+
+    // EMPTY and DELETED are the only control values with the sign bit set
+    bitmask match_empty_or_deleted() const noexcept
+    {
+#ifdef CACHEW_SWISS_MAP_SSE2
+        return bitmask(
+            static_cast<std::uint32_t>( _mm_movemask_epi8( _ctrl ) ) );
+#else
+        std::uint32_t mask = 0;
+        for( std::size_t i = 0; i < GROUP_WIDTH; ++i )
+        {
+            mask |= static_cast<std::uint32_t>( _ctrl[i] < 0 ) << i;
+        }
+        return bitmask( mask );
+#endif
+    }
+
+private:
+#ifdef CACHEW_SWISS_MAP_SSE2
+    __m128i _ctrl;
+#else
+    ctrl_t _ctrl[GROUP_WIDTH];
+#endif
+};
+
+} // namespace swiss_detail
+
+// Open addressing hash map with 1-byte hash tags, probed one 16-slot group at
+// a time. Groups are aligned to GROUP_WIDTH, so a lookup touches one control
+// group and one slot in the common case. Iterators are invalidated by
+// inserts which grow the table, pointers to the mapped values are not stable.
+template <class _Key, class _Tp, class _Hash = std::hash<_Key>,
+          class _KeyEqual = std::equal_to<_Key>>
+class swiss_map
+{
+public:
+    using key_type    = _Key;
+    using mapped_type = _Tp;
+    // keys are movable to support rehashing, they must not be changed through
+    // an iterator
+    using value_type = std::pair<key_type, mapped_type>;
+    using size_type  = std::size_t;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+private:
+    using ctrl_t = swiss_detail::ctrl_t;
+
+    template <bool _Const>
+    class basic_iterator
+    {
+        friend class swiss_map;
+
+        using slot_type = typename swiss_map::value_type;
+        using slot_ptr  =
+            std::conditional_t<_Const, const slot_type *, slot_type *>;
+
+    public:
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = slot_type;
+        using iterator_category = std::forward_iterator_tag;
+
+        using pointer   = slot_ptr;
+        using reference = std::conditional_t<_Const, const value_type &,
+                                             value_type &>;
+
+        basic_iterator() = default;
+
+        template <bool _OtherConst,
+                  class = std::enable_if_t<_Const && !_OtherConst>>
+        basic_iterator( const basic_iterator<_OtherConst> &it )
+            : _ctrl( it._ctrl )
+            , _ctrl_end( it._ctrl_end )
+            , _slot( it._slot )
+        {
+        }
+
+        bool operator==( const basic_iterator &it ) const
+        {
+            return _slot == it._slot;
+        }
+
+        bool operator!=( const basic_iterator &it ) const
+        {
+            return _slot != it._slot;
+        }
+
+        basic_iterator &operator++()
+        {
+            ++_ctrl;
+            ++_slot;
+            skip_free();
+            return *this;
+        }
+
+        basic_iterator operator++( int )
+        {
+            basic_iterator res( *this );
+            ++( *this );
+            return res;
+        }
+
+        reference operator*() const
+        {
+            return *_slot;
+        }
+
+        pointer operator->() const
+        {
+            return _slot;
+        }
+
+    private:
+        basic_iterator( const ctrl_t *ctrl, const ctrl_t *ctrl_end,
+                        slot_ptr slot )
+            : _ctrl( ctrl )
+            , _ctrl_end( ctrl_end )
+            , _slot( slot )
+        {
+        }
+
+        void skip_free()
+        {
+            while( _ctrl != _ctrl_end && !swiss_detail::is_full( *_ctrl ) )
+            {
+                ++_ctrl;
+                ++_slot;
+            }
+        }
+
+        const ctrl_t *_ctrl     = nullptr;
+        const ctrl_t *_ctrl_end = nullptr;
+        slot_ptr      _slot     = nullptr;
+    };
+
+    // enables lookups by any key type if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous = std::enable_if_t<
+        is_transparent<hasher, key_equal>::value &&
+        !std::is_convertible_v<const _K &, basic_iterator<true>>>;
+
+public:
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    swiss_map() = default;
+
+    swiss_map( const swiss_map &other )
+        : _hash( other._hash )
+        , _eq( other._eq )
+    {
+        if( other._size == 0 )
+        {
+            return;
+        }
+        // the layout is copied as is, tombstones included, as they keep the
+        // probe sequences of the present keys valid
+        allocate( other._capacity );
+        try
+        {
+            for( size_type i = 0; i < _capacity; ++i )
+            {
+                if( swiss_detail::is_full( other._ctrl[i] ) )
+                {
+                    ::new( static_cast<void *>( _slots + i ) )
+                        value_type( other._slots[i] );
+                    ++_size;
+                }
+                _ctrl[i] = other._ctrl[i];
+            }
+        }
+        catch( ... )
+        {
+            destroy_slots();
+            deallocate();
+            throw;
+        }
+        _growth_left = other._growth_left;
+    }
+
+    swiss_map( swiss_map &&other ) noexcept
+        : _ctrl( std::exchange( other._ctrl, nullptr ) )
+        , _slots( std::exchange( other._slots, nullptr ) )
+        , _capacity( std::exchange( other._capacity, 0 ) )
+        , _size( std::exchange( other._size, 0 ) )
+        , _growth_left( std::exchange( other._growth_left, 0 ) )
+        , _hash( other._hash )
+        , _eq( other._eq )
+    {
+    }
+
+    swiss_map &operator=( const swiss_map &other )
+    {
+        if( this != &other )
+        {
+            swiss_map tmp( other );
+            swap( tmp );
+        }
+        return *this;
+    }
+
+    swiss_map &operator=( swiss_map &&other ) noexcept
+    {
+        if( this != &other )
+        {
+            swiss_map tmp( std::move( other ) );
+            swap( tmp );
+        }
+        return *this;
+    }
+
+    ~swiss_map()
+    {
+        destroy_slots();
+        deallocate();
+    }
+
+    void swap( swiss_map &other ) noexcept
+    {
+        std::swap( _ctrl, other._ctrl );
+        std::swap( _slots, other._slots );
+        std::swap( _capacity, other._capacity );
+        std::swap( _size, other._size );
+        std::swap( _growth_left, other._growth_left );
+        std::swap( _hash, other._hash );
+        std::swap( _eq, other._eq );
+    }
+
+    iterator find( const key_type &key )
+    {
+        size_type pos = find_pos( key );
+        return pos == _capacity ? end() : iterator_at( pos );
+    }
+
+    const_iterator find( const key_type &key ) const
+    {
+        size_type pos = find_pos( key );
+        return pos == _capacity ? end() : const_iterator( iterator_at( pos ) );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator find( const _K &key )
+    {
+        size_type pos = find_pos( key );
+        return pos == _capacity ? end() : iterator_at( pos );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    const_iterator find( const _K &key ) const
+    {
+        size_type pos = find_pos( key );
+        return pos == _capacity ? end() : const_iterator( iterator_at( pos ) );
+    }
+
+    // Hash of `key` as used by the map, it may be passed to `prefetch` and to
+    // `find` to split a lookup into steps.
+    template <class _K>
+    std::size_t hash( const _K &key ) const
+    {
+        return swiss_detail::mix( _hash( key ) );
+    }
+
+    // Prefetches the first control group and slot group probed for `hash`.
+    void prefetch( std::size_t hash ) const noexcept
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        const size_type offset =
+            ( swiss_detail::h1( hash ) &
+              ( _capacity / swiss_detail::GROUP_WIDTH - 1 ) ) *
+            swiss_detail::GROUP_WIDTH;
+        cachew::prefetch( _ctrl + offset );
+        cachew::prefetch( _slots + offset );
+    }
+
+    // `hash` must be the result of `hash( key )`.
+    template <class _K>
+    iterator find( const _K &key, std::size_t hash )
+    {
+        size_type pos = find_pos( key, hash );
+        return pos == _capacity ? end() : iterator_at( pos );
+    }
+
+    template <class... _Args>
+    std::pair<iterator, bool> emplace( const key_type &key, _Args &&... args )
+    {
+        std::size_t hash = swiss_detail::mix( _hash( key ) );
+        size_type   pos  = find_pos( key, hash );
+        if( pos != _capacity )
+        {
+            return {iterator_at( pos ), false};
+        }
+
+        pos = prepare_insert( hash );
+        ::new( static_cast<void *>( _slots + pos ) ) value_type(
+            std::piecewise_construct, std::forward_as_tuple( key ),
+            std::forward_as_tuple( std::forward<_Args>( args )... ) );
+        set_ctrl( pos, swiss_detail::h2( hash ) );
+        ++_size;
+
+        return {iterator_at( pos ), true};
+    }
+
+    // The same as `emplace`, which never builds an element for a present key.
+    template <class... _Args>
+    std::pair<iterator, bool> try_emplace( const key_type &key,
+                                           _Args &&... args )
+    {
+        return emplace( key, std::forward<_Args>( args )... );
+    }
+
+    size_type erase( const key_type &key )
+    {
+        return erase_key( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    size_type erase( const _K &key )
+    {
+        return erase_key( key );
+    }
+
+    iterator erase( const_iterator it )
+    {
+        size_type pos = static_cast<size_type>( it._slot - _slots );
+        erase_at( pos );
+        iterator res = iterator_at( pos );
+        res.skip_free();
+        return res;
+    }
+
+    void clear() noexcept
+    {
+        destroy_slots();
+        if( _capacity > 0 )
+        {
+            std::memset( _ctrl, swiss_detail::EMPTY, _capacity );
+        }
+        _size        = 0;
+        _growth_left = max_load( _capacity );
+    }
+
+    void reserve( size_type count )
+    {
+        size_type capacity = swiss_detail::GROUP_WIDTH;
+        while( max_load( capacity ) < count )
+        {
+            capacity *= 2;
+        }
+        if( capacity > _capacity )
+        {
+            rehash( capacity );
+        }
+    }
+
+    iterator begin() noexcept
+    {
+        iterator it = iterator_at( 0 );
+        it.skip_free();
+        return it;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        const_iterator it = iterator_at( 0 );
+        it.skip_free();
+        return it;
+    }
+
+    iterator end() noexcept
+    {
+        return iterator_at( _capacity );
+    }
+
+    const_iterator end() const noexcept
+    {
+        return iterator_at( _capacity );
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return _size;
+    }
+
+private:
+    static size_type max_load( size_type capacity ) noexcept
+    {
+        return capacity - capacity / 8;
+    }
+
+    iterator iterator_at( size_type pos ) const noexcept
+    {
+        return iterator( _ctrl + pos, _ctrl + _capacity, _slots + pos );
+    }
+
+    template <class _K>
+    size_type find_pos( const _K &key ) const
+    {
+        return find_pos( key, swiss_detail::mix( _hash( key ) ) );
+    }
+
+    // Returns `_capacity` if there is no such key.
+    template <class _K>
+    size_type find_pos( const _K &key, std::size_t hash ) const
+    {
+        if( _capacity == 0 )
+        {
+            return _capacity;
+        }
+
+        const size_type groups_mask =
+            _capacity / swiss_detail::GROUP_WIDTH - 1;
+        const ctrl_t tag   = swiss_detail::h2( hash );
+        size_type    group = swiss_detail::h1( hash ) & groups_mask;
+
+        for( size_type step = 1;; ++step )
+        {
+            const size_type     offset = group * swiss_detail::GROUP_WIDTH;
+            swiss_detail::group g( _ctrl + offset );
+
+            for( auto match = g.match( tag ); match; match.clear_lowest() )
+            {
+                size_type pos = offset + match.lowest();
+                if( _eq( _slots[pos].first, key ) )
+                {
+                    return pos;
+                }
+            }
+            if( g.match_empty() )
+            {
+                return _capacity;
+            }
+            group = ( group + step ) & groups_mask;
+        }
+    }
+
+    template <class _K>
+    size_type erase_key( const _K &key )
+    {
+        size_type pos = find_pos( key );
+        if( pos == _capacity )
+        {
+            return 0;
+        }
+        erase_at( pos );
+        return 1;
+    }
+
+    // Finds a free slot for a new element, growing the table if there is
+    // no room left.
+    size_type prepare_insert( std::size_t hash )
+    {
+        size_type pos = find_free( hash );
+        if( _growth_left == 0 &&
+            ( _capacity == 0 || _ctrl[pos] != swiss_detail::DELETED ) )
+        {
+            // the table is either full or polluted by tombstones
+            rehash( _size * 2 < max_load( _capacity )
+                        ? _capacity
+                        : std::max( _capacity * 2,
+                                    swiss_detail::GROUP_WIDTH ) );
+            pos = find_free( hash );
+        }
+        return pos;
+    }
+
+    size_type find_free( std::size_t hash ) const
+    {
+        if( _capacity == 0 )
+        {
+            return 0;
+        }
+
+        const size_type groups_mask =
+            _capacity / swiss_detail::GROUP_WIDTH - 1;
+        size_type group = swiss_detail::h1( hash ) & groups_mask;
+
+        for( size_type step = 1;; ++step )
+        {
+            const size_type     offset = group * swiss_detail::GROUP_WIDTH;
+            swiss_detail::group g( _ctrl + offset );
+
+            auto free = g.match_empty_or_deleted();
+            if( free )
+            {
+                return offset + free.lowest();
+            }
+            group = ( group + step ) & groups_mask;
+        }
+    }
+
+    void set_ctrl( size_type pos, ctrl_t tag ) noexcept
+    {
+        if( _ctrl[pos] == swiss_detail::EMPTY )
+        {
+            --_growth_left;
+        }
+        _ctrl[pos] = tag;
+    }
+
+    void erase_at( size_type pos ) noexcept
+    {
+        _slots[pos].~value_type();
+        --_size;
+
+        // Groups are aligned, so a probe sequence passes a group only if the
+        // group had no free slots. If the group still has an empty slot, no
+        // lookup ever continued past it and the slot may become empty.
+        const size_type offset = pos - pos % swiss_detail::GROUP_WIDTH;
+        if( swiss_detail::group( _ctrl + offset ).match_empty() )
+        {
+            _ctrl[pos] = swiss_detail::EMPTY;
+            ++_growth_left;
+        }
+        else
+        {
+            _ctrl[pos] = swiss_detail::DELETED;
+        }
+    }
+
+    void rehash( size_type capacity )
+    {
+        ctrl_t *     old_ctrl     = _ctrl;
+        value_type * old_slots    = _slots;
+        size_type    old_capacity = _capacity;
+
+        allocate( capacity );
+        for( size_type i = 0; i < old_capacity; ++i )
+        {
+            if( swiss_detail::is_full( old_ctrl[i] ) )
+            {
+                std::size_t hash =
+                    swiss_detail::mix( _hash( old_slots[i].first ) );
+                size_type pos = find_free( hash );
+                ::new( static_cast<void *>( _slots + pos ) )
+                    value_type( std::move( old_slots[i] ) );
+                old_slots[i].~value_type();
+                set_ctrl( pos, swiss_detail::h2( hash ) );
+            }
+        }
+
+        delete[] old_ctrl;
+        std::allocator<value_type>().deallocate( old_slots, old_capacity );
+    }
+
+    // Replaces the current arrays with empty ones, the old arrays are left
+    // to the caller.
+    void allocate( size_type capacity )
+    {
+        std::unique_ptr<ctrl_t[]> ctrl( new ctrl_t[capacity] );
+        _slots    = std::allocator<value_type>().allocate( capacity );
+        _ctrl     = ctrl.release();
+        _capacity = capacity;
+        std::memset( _ctrl, swiss_detail::EMPTY, _capacity );
+        _growth_left = max_load( _capacity );
+    }
+
+    void destroy_slots() noexcept
+    {
+        for( size_type i = 0; i < _capacity; ++i )
+        {
+            if( swiss_detail::is_full( _ctrl[i] ) )
+            {
+                _slots[i].~value_type();
+            }
+        }
+    }
+
+    void deallocate() noexcept
+    {
+        delete[] _ctrl;
+        if( _slots != nullptr )
+        {
+            std::allocator<value_type>().deallocate( _slots, _capacity );
+        }
+    }
+
+    ctrl_t *    _ctrl        = nullptr;
+    value_type *_slots       = nullptr;
+    size_type   _capacity    = 0;
+    size_type   _size        = 0;
+    size_type   _growth_left = 0;
+    hasher      _hash;
+    key_equal   _eq;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_SWISS_MAP_HPP
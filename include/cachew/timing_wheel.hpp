@@ -0,0 +1,246 @@
+#ifndef CACHEW_TIMING_WHEEL_HPP
+#define CACHEW_TIMING_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace cachew
+{
+
+// Resolution of the cache timers.
+using wheel_tick = std::chrono::milliseconds;
+
+// Ticks elapsed by `time`, rounded down.
+template <class _TimePoint>
+inline std::uint64_t wheel_ticks( const _TimePoint &time )
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::floor<wheel_tick>( time.time_since_epoch() ).count() );
+}
+
+// Tick at which a timer for `deadline` fires, it never fires early.
+template <class _TimePoint>
+inline std::uint64_t wheel_deadline_ticks( const _TimePoint &deadline )
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::ceil<wheel_tick>( deadline.time_since_epoch() ).count() );
+}
+
+// Hierarchical timing wheel. Level `n` has 64 slots of 64^n ticks each, a
+// timer is kept at the lowest level which covers its deadline and moves one
+// level down every time the wheel reaches the slot it is in. Scheduling and
+// cancelling are O(1), advancing is O(1) amortized per timer plus the number
+// of reached slots with timers, empty levels are skipped.
+template <class _Tp>
+class timing_wheel
+{
+    static constexpr std::size_t LEVEL_BITS = 6;
+    static constexpr std::size_t SLOTS      = 1 << LEVEL_BITS;
+    static constexpr std::size_t LEVELS     = 5;
+
+    // further timers are kept at the last slot and rescheduled from there
+    static constexpr std::uint64_t MAX_DELTA =
+        ( std::uint64_t( 1 ) << ( LEVELS * LEVEL_BITS ) ) - 1;
+
+    struct timer
+    {
+        std::uint64_t deadline;
+        std::size_t   slot;
+        _Tp           value;
+    };
+
+    using timer_list = std::list<timer>;
+
+public:
+    using handle = typename timer_list::iterator;
+
+    explicit timing_wheel( std::uint64_t now = 0 ) noexcept
+        : _now( now )
+        , _size( 0 )
+        , _counts{}
+    {
+    }
+
+    // handles refer to the timers of the wheel they were returned by
+    timing_wheel( const timing_wheel &other ) = delete;
+
+    timing_wheel( timing_wheel &&other ) noexcept
+        : _slots( std::move( other._slots ) )
+        , _now( other._now )
+        , _size( std::exchange( other._size, 0 ) )
+        , _counts( std::exchange( other._counts, {} ) )
+    {
+    }
+
+    timing_wheel &operator=( const timing_wheel &other ) = delete;
+
+    timing_wheel &operator=( timing_wheel &&other ) noexcept
+    {
+        _slots  = std::move( other._slots );
+        _now    = other._now;
+        _size   = std::exchange( other._size, 0 );
+        _counts = std::exchange( other._counts, {} );
+        return *this;
+    }
+
+    std::uint64_t now() const noexcept
+    {
+        return _now;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    // Timers which are already due fire on the next tick.
+    handle schedule( std::uint64_t deadline, _Tp value )
+    {
+        if( _slots.empty() )
+        {
+            _slots.resize( LEVELS * SLOTS );
+        }
+        timer_list pending;
+        pending.push_back( timer{ deadline, 0, std::move( value ) } );
+
+        handle h = pending.begin();
+        link( pending, h );
+        ++_size;
+        return h;
+    }
+
+    void cancel( handle h ) noexcept
+    {
+        --_counts[h->slot / SLOTS];
+        --_size;
+        _slots[h->slot].erase( h );
+    }
+
+    // Replaces the value of a scheduled timer.
+    void update( handle h, _Tp value )
+    {
+        h->value = std::move( value );
+    }
+
+    // Moves the wheel to the `now` tick and calls `expire` with the value of
+    // every timer which is due, a fired timer is already removed. `expire`
+    // must not throw.
+    template <class _Fn>
+    void advance( std::uint64_t now, _Fn &&expire )
+    {
+        while( _now < now )
+        {
+            std::size_t level = 0;
+            while( level < LEVELS && _counts[level] == 0 )
+            {
+                ++level;
+            }
+            if( level == LEVELS )
+            {
+                _now = now;
+                break;
+            }
+            // nothing happens until the next slot of the lowest used level
+            std::uint64_t next = ( _now / span( level ) + 1 ) * span( level );
+            if( next > now )
+            {
+                _now = now;
+                break;
+            }
+            _now = next;
+            tick( expire );
+        }
+    }
+
+private:
+    // Ticks covered by a slot of `level`.
+    static constexpr std::uint64_t span( std::size_t level )
+    {
+        return std::uint64_t( 1 ) << ( level * LEVEL_BITS );
+    }
+
+    static std::size_t slot_index( std::uint64_t tick, std::size_t level )
+    {
+        std::uint64_t index = ( tick / span( level ) ) % SLOTS;
+        return level * SLOTS + static_cast<std::size_t>( index );
+    }
+
+    // Moves `h` from `from` to the slot of its deadline.
+    void link( timer_list &from, handle h ) noexcept
+    {
+        std::uint64_t deadline = std::max( h->deadline, _now + 1 );
+        std::uint64_t delta    = std::min( deadline - _now, MAX_DELTA );
+        deadline               = _now + delta;
+
+        std::size_t level = 0;
+        while( delta >= span( level + 1 ) )
+        {
+            ++level;
+        }
+        h->slot = slot_index( deadline, level );
+        ++_counts[level];
+
+        timer_list &slot = _slots[h->slot];
+        slot.splice( slot.end(), from, h );
+    }
+
+    // `_now` has just reached a slot boundary of the lowest used level.
+    template <class _Fn>
+    void tick( _Fn &expire )
+    {
+        std::size_t top = 0;
+        while( top + 1 < LEVELS && _now % span( top + 1 ) == 0 )
+        {
+            ++top;
+        }
+
+        timer_list due;
+        for( std::size_t level = top; level > 0; --level )
+        {
+            timer_list &slot = _slots[slot_index( _now, level )];
+            _counts[level] -= slot.size();
+            due.splice( due.end(), slot );
+            while( !due.empty() )
+            {
+                link( due, due.begin() );
+            }
+        }
+
+        timer_list &slot = _slots[slot_index( _now, 0 )];
+        _counts[0] -= slot.size();
+        due.splice( due.end(), slot );
+        while( !due.empty() )
+        {
+            handle h = due.begin();
+            if( h->deadline > _now )
+            {
+                // a timer beyond `MAX_DELTA` when it was scheduled
+                link( due, h );
+                continue;
+            }
+            _Tp value = std::move( h->value );
+            due.erase( h );
+            --_size;
+            expire( value );
+        }
+    }
+
+    std::vector<timer_list>         _slots;
+    std::uint64_t                   _now;
+    std::size_t                     _size;
+    std::array<std::size_t, LEVELS> _counts;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_TIMING_WHEEL_HPP
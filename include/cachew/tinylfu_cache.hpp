@@ -0,0 +1,486 @@
+#ifndef CACHEW_TINYLFU_CACHE_HPP
+#define CACHEW_TINYLFU_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "frequency_sketch.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// W-TinyLFU cache. New entries go to a small LRU window, about 1% of the
+// capacity. The entry pushed out of the window is admitted to the main SLRU
+// region only if the frequency sketch estimates it was accessed more often
+// than the main victim, the last probationary entry, so a new key does not
+// push out a key with a better history. Hits and puts are counted by the
+// sketch, misses of `get` are not.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class tinylfu_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    enum class segment : unsigned char
+    {
+        window,
+        probation,
+        protected_
+    };
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        segment where = segment::window;
+    };
+
+    // All segments share one list: the protected entries, the probationary
+    // ones, then the window, each from the most recently used entry.
+    using tinylfu_list = std::list<entry>;
+    using tinylfu_map  = typename _Index::template map_type<
+        key_type, typename tinylfu_list::iterator, hasher, key_equal>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename tinylfu_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const tinylfu_cache &lhs,
+                            const tinylfu_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // The window takes 1% of the capacity, at least one entry, and the
+    // protected segment 80% of the main region.
+    explicit tinylfu_cache( size_t capacity )
+        : _probation( _list.end() )
+        , _window( _list.end() )
+        , _sketch( capacity )
+        , _capacity( capacity )
+        , _window_capacity(
+              std::min( capacity, std::max<size_t>( capacity / 100, 1 ) ) )
+        , _protected_capacity( ( capacity - _window_capacity ) * 4 / 5 )
+        , _window_size( 0 )
+        , _protected_size( 0 )
+    {
+    }
+
+    tinylfu_cache( const tinylfu_cache &other )
+        : _list( other._list )
+        , _probation( _list.end() )
+        , _window( _list.end() )
+        , _sketch( other._sketch )
+        , _capacity( other._capacity )
+        , _window_capacity( other._window_capacity )
+        , _protected_capacity( other._protected_capacity )
+        , _window_size( other._window_size )
+        , _protected_size( other._protected_size )
+        , _hash( other._hash )
+    {
+        // `_map` and the segment splits refer to the nodes of `other` and
+        // have to be rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+        }
+        _probation = std::find_if( _list.begin(), _list.end(),
+                                   []( const entry &e ) {
+                                       return e.where != segment::protected_;
+                                   } );
+        _window = std::find_if( _probation, _list.end(), []( const entry &e ) {
+            return e.where == segment::window;
+        } );
+    }
+
+    tinylfu_cache( tinylfu_cache &&other )
+        : tinylfu_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    tinylfu_cache &operator=( const tinylfu_cache &other )
+    {
+        if( this != &other )
+        {
+            tinylfu_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    tinylfu_cache &operator=( tinylfu_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            bool probation_tail = other._probation == other._list.end();
+            bool window_tail    = other._window == other._list.end();
+            auto probation      = other._probation;
+            auto window         = other._window;
+
+            _list               = std::move( other._list );
+            _map                = std::move( other._map );
+            _probation          = probation_tail ? _list.end() : probation;
+            _window             = window_tail ? _list.end() : window;
+            _capacity           = other._capacity;
+            _window_capacity    = other._window_capacity;
+            _protected_capacity = other._protected_capacity;
+            _window_size        = other._window_size;
+            _protected_size     = other._protected_size;
+            _hash               = other._hash;
+
+            // the moved-from cache keeps a usable sketch
+            std::swap( _sketch, other._sketch );
+            other._sketch.clear();
+            other._map.clear();
+            other._list.clear();
+            other._probation      = other._list.end();
+            other._window         = other._list.end();
+            other._window_size    = 0;
+            other._protected_size = 0;
+        }
+        return *this;
+    }
+
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries and the frequencies learned by the sketch.
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _sketch.clear();
+        _probation      = _list.end();
+        _window         = _list.end();
+        _window_size    = 0;
+        _protected_size = 0;
+    }
+
+    // An update is a hit.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        _sketch.increment( _hash( key ) );
+
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            it->second->second = std::forward<_PutT>( value );
+            touch( it->second );
+            return;
+        }
+        try
+        {
+            auto pos = _list.emplace( _window, key,
+                                      std::forward<_PutT>( value ) );
+            if( _probation == _window )
+            {
+                _probation = pos;
+            }
+            _window = pos;
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+        it->second = _window;
+
+        if( ++_window_size > _window_capacity )
+        {
+            leave_window();
+        }
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t window_capacity() const noexcept
+    {
+        return _window_capacity;
+    }
+
+    size_t protected_capacity() const noexcept
+    {
+        return _protected_capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    size_t window_size() const noexcept
+    {
+        return _window_size;
+    }
+
+    size_t protected_size() const noexcept
+    {
+        return _protected_size;
+    }
+
+    // Estimated access frequency of `key`.
+    unsigned frequency( const key_type &key ) const noexcept
+    {
+        return _sketch.frequency( _hash( key ) );
+    }
+
+    // Protected entries go first, the window entries last.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    // The last window entry goes to probation if the main region has room
+    // or if it is more frequent than the main victim, it is evicted
+    // otherwise.
+    void leave_window()
+    {
+        auto   candidate = std::prev( _list.end() );
+        size_t main_size = _list.size() - _window_size;
+        if( main_size >= _capacity - _window_capacity )
+        {
+            if( main_size == 0 || !admit( *candidate, *std::prev( _window ) ) )
+            {
+                _map.erase( candidate->first );
+                unlink( candidate );
+                return;
+            }
+            auto victim = std::prev( _window );
+            _map.erase( victim->first );
+            unlink( victim );
+        }
+        --_window_size;
+        candidate->where = segment::probation;
+        _list.splice( _probation, _list, candidate );
+        _probation = candidate;
+    }
+
+    bool admit( const entry &candidate, const entry &victim ) const noexcept
+    {
+        return _sketch.frequency( _hash( candidate.first ) ) >
+               _sketch.frequency( _hash( victim.first ) );
+    }
+
+    void touch( typename tinylfu_list::iterator pos )
+    {
+        switch( pos->where )
+        {
+        case segment::window:
+            if( pos != _window )
+            {
+                _list.splice( _window, _list, pos );
+                if( _probation == _window )
+                {
+                    _probation = pos;
+                }
+                _window = pos;
+            }
+            break;
+        case segment::probation:
+            promote( pos );
+            break;
+        case segment::protected_:
+            _list.splice( _list.begin(), _list, pos );
+            break;
+        }
+    }
+
+    // Moves a probationary entry to the front of the protected segment.
+    void promote( typename tinylfu_list::iterator pos )
+    {
+        if( pos == _probation )
+        {
+            ++_probation;
+        }
+        _list.splice( _list.begin(), _list, pos );
+        pos->where = segment::protected_;
+        if( ++_protected_size > _protected_capacity )
+        {
+            // the last protected entry becomes the first probationary one
+            --_probation;
+            _probation->where = segment::probation;
+            --_protected_size;
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        _sketch.increment( _hash( it->first ) );
+        touch( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename tinylfu_list::iterator pos ) noexcept
+    {
+        auto next = std::next( pos );
+        if( pos == _probation )
+        {
+            _probation = next;
+        }
+        if( pos == _window )
+        {
+            _window = next;
+        }
+        if( pos->where == segment::window )
+        {
+            --_window_size;
+        }
+        else if( pos->where == segment::protected_ )
+        {
+            --_protected_size;
+        }
+        _list.erase( pos );
+    }
+
+    tinylfu_list                    _list;
+    tinylfu_map                     _map;
+    typename tinylfu_list::iterator _probation;
+    typename tinylfu_list::iterator _window;
+    frequency_sketch                _sketch;
+    size_t                          _capacity;
+    size_t                          _window_capacity;
+    size_t                          _protected_capacity;
+    size_t                          _window_size;
+    size_t                          _protected_size;
+    hasher                          _hash;
+};
+
+// W-TinyLFU eviction for `basic_cache`.
+struct tinylfu_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = tinylfu_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_TINYLFU_CACHE_HPP
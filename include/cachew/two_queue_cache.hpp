@@ -0,0 +1,452 @@
+#ifndef CACHEW_TWO_QUEUE_CACHE_HPP
+#define CACHEW_TWO_QUEUE_CACHE_HPP
+
+#include "basic_cache.hpp"
+#include "cache_iterator.hpp"
+#include "index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+
+namespace cachew
+{
+
+// 2Q cache. A new key enters the A1in FIFO, a hit there does not move it, and
+// when it is pushed out of A1in only its hash is remembered by the A1out
+// ghost FIFO. A key which comes back while its hash is in A1out is put to Am,
+// an LRU of the keys seen more than once. Keys seen once never push the Am
+// keys out while A1in is over its share of the capacity.
+template <class _Key, class _Tp, class _Index = std_index,
+          class _Hash = default_hash<_Key>,
+          class _KeyEqual = default_key_equal<_Key>>
+class two_queue_cache
+{
+public:
+    using key_type   = _Key;
+    using value_type = _Tp;
+    using hasher     = _Hash;
+    using key_equal  = _KeyEqual;
+
+    using kv_pair = std::pair<key_type, value_type>;
+
+    struct entry : kv_pair
+    {
+        using kv_pair::kv_pair;
+
+        bool is_hot = false;
+    };
+
+    // Am and A1in share one list: the Am entries, from the most recently
+    // used, are followed by the A1in ones, from the newest.
+    using queue_list = std::list<entry>;
+    using queue_map  = typename _Index::template map_type<
+        key_type, typename queue_list::iterator, hasher, key_equal>;
+
+    // A1out holds key hashes, from the newest.
+    using ghost_list = std::list<std::size_t>;
+    using ghost_map  = typename _Index::template map_type<
+        std::size_t, typename ghost_list::iterator,
+        default_hash<std::size_t>, default_key_equal<std::size_t>>;
+
+private:
+    struct accessor
+    {
+        using const_iterator = typename queue_list::const_iterator;
+
+        inline explicit accessor( const const_iterator &it )
+            : _it( it )
+        {
+        }
+        inline const value_type &ref() const
+        {
+            return _it->second;
+        }
+        inline const value_type *ptr() const
+        {
+            return &( _it->second );
+        }
+
+        const const_iterator &_it;
+    };
+
+    // lookups by other key types are enabled if the functors are transparent
+    template <class _K>
+    using enable_if_heterogeneous =
+        std::enable_if_t<is_transparent<hasher, key_equal>::value &&
+                         !std::is_same_v<_K, key_type>>;
+
+public:
+    using iterator = cache_const_iterator<accessor, value_type>;
+
+    friend bool operator!=( const two_queue_cache &lhs,
+                            const two_queue_cache &rhs )
+    {
+        return !( rhs == lhs );
+    }
+
+    // A1in takes 25% of the capacity and A1out remembers as many keys as
+    // 50% of it, the sizes suggested by the 2Q paper.
+    explicit two_queue_cache( size_t capacity )
+        : two_queue_cache( capacity, capacity / 4, capacity / 2 )
+    {
+    }
+
+    two_queue_cache( size_t capacity, size_t in_capacity,
+                     size_t ghost_capacity )
+        : _in( _list.end() )
+        , _capacity( capacity )
+        , _in_capacity( in_capacity )
+        , _ghost_capacity( ghost_capacity )
+        , _in_size( 0 )
+    {
+    }
+
+    two_queue_cache( const two_queue_cache &other )
+        : _list( other._list )
+        , _in( _list.end() )
+        , _ghost( other._ghost )
+        , _capacity( other._capacity )
+        , _in_capacity( other._in_capacity )
+        , _ghost_capacity( other._ghost_capacity )
+        , _in_size( other._in_size )
+        , _hash( other._hash )
+    {
+        // `_map`, `_in` and `_ghost_map` refer to the nodes of `other` and
+        // have to be rebuilt
+        _map.reserve( _list.size() );
+        for( auto it = _list.begin(); it != _list.end(); ++it )
+        {
+            _map.emplace( it->first, it );
+        }
+        _in = std::find_if( _list.begin(), _list.end(),
+                            []( const entry &e ) { return !e.is_hot; } );
+
+        _ghost_map.reserve( _ghost.size() );
+        for( auto it = _ghost.begin(); it != _ghost.end(); ++it )
+        {
+            _ghost_map.emplace( *it, it );
+        }
+    }
+
+    two_queue_cache( two_queue_cache &&other )
+        : two_queue_cache( 0 )
+    {
+        *this = std::move( other );
+    }
+
+    two_queue_cache &operator=( const two_queue_cache &other )
+    {
+        if( this != &other )
+        {
+            two_queue_cache tmp( other );
+            *this = std::move( tmp );
+        }
+        return *this;
+    }
+
+    two_queue_cache &operator=( two_queue_cache &&other )
+    {
+        if( this != &other )
+        {
+            // the end iterator of a list does not survive its move
+            auto in      = other._in;
+            bool in_tail = in == other._list.end();
+
+            _list           = std::move( other._list );
+            _map            = std::move( other._map );
+            _in             = in_tail ? _list.end() : in;
+            _ghost          = std::move( other._ghost );
+            _ghost_map      = std::move( other._ghost_map );
+            _capacity       = other._capacity;
+            _in_capacity    = other._in_capacity;
+            _ghost_capacity = other._ghost_capacity;
+            _in_size        = std::exchange( other._in_size, 0 );
+            _hash           = other._hash;
+
+            other.clear();
+        }
+        return *this;
+    }
+
+    // A hit moves an Am entry to the front of Am, an A1in entry stays put.
+    iterator get( const key_type &key )
+    {
+        return get_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    iterator get( const _K &key )
+    {
+        return get_impl( key );
+    }
+
+    bool contains( const key_type &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool contains( const _K &key ) const
+    {
+        return index_find<_Index>( _map, key ) != _map.end();
+    }
+
+    // Erased keys are not remembered by A1out.
+    bool erase( const key_type &key )
+    {
+        return erase_impl( key );
+    }
+
+    template <class _K, class = enable_if_heterogeneous<_K>>
+    bool erase( const _K &key )
+    {
+        return erase_impl( key );
+    }
+
+    // Removes the entries for which `pred( key, value )` is true, returns the
+    // number of removed entries.
+    template <class _Pred>
+    size_t erase_if( _Pred pred )
+    {
+        size_t removed = 0;
+        for( auto it = _list.begin(); it != _list.end(); )
+        {
+            auto           pos   = it++;
+            const kv_pair &entry = *pos;
+            if( pred( entry.first, entry.second ) )
+            {
+                _map.erase( pos->first );
+                unlink( pos );
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Removes all entries and forgets the keys of A1out.
+    void clear() noexcept
+    {
+        _map.clear();
+        _list.clear();
+        _ghost_map.clear();
+        _ghost.clear();
+        _in      = _list.end();
+        _in_size = 0;
+    }
+
+    // An update is a hit, so it moves the entry as `get` does.
+    template <class _PutT>
+    void put( const key_type &key, _PutT &&value )
+    {
+        if( _capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _map.try_emplace( key );
+        if( !inserted )
+        {
+            it->second->second = std::forward<_PutT>( value );
+            touch( it->second );
+            return;
+        }
+
+        // the entry is made before anything is evicted for it
+        queue_list pending;
+        try
+        {
+            pending.emplace_back( key, std::forward<_PutT>( value ) );
+            if( _map.size() > _capacity )
+            {
+                reclaim();
+            }
+        }
+        catch( ... )
+        {
+            _map.erase( it );
+            throw;
+        }
+
+        auto ghost = _ghost_map.find( _hash( key ) );
+        if( ghost != _ghost_map.end() )
+        {
+            _ghost.erase( ghost->second );
+            _ghost_map.erase( ghost );
+
+            pending.front().is_hot = true;
+            _list.splice( _list.begin(), pending );
+            it->second = _list.begin();
+            return;
+        }
+        _list.splice( _in, pending );
+        _in        = std::prev( _in );
+        it->second = _in;
+        ++_in_size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    size_t in_capacity() const noexcept
+    {
+        return _in_capacity;
+    }
+
+    size_t ghost_capacity() const noexcept
+    {
+        return _ghost_capacity;
+    }
+
+    size_t size() const noexcept
+    {
+        return _map.size();
+    }
+
+    // Number of entries in A1in.
+    size_t in_size() const noexcept
+    {
+        return _in_size;
+    }
+
+    // Number of hashes in A1out.
+    size_t ghost_size() const noexcept
+    {
+        return _ghost.size();
+    }
+
+    // Am entries go first.
+    iterator begin() const noexcept
+    {
+        return iterator( _list.begin() );
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator( _list.end() );
+    }
+
+private:
+    void touch( typename queue_list::iterator pos )
+    {
+        if( pos->is_hot )
+        {
+            _list.splice( _list.begin(), _list, pos );
+        }
+    }
+
+    // Makes room for a new entry: the oldest A1in entry goes to A1out if
+    // A1in is over its share or Am is empty, the last Am entry is dropped
+    // otherwise.
+    void reclaim()
+    {
+        bool am_empty = _in == _list.begin();
+        if( _in_size > 0 && ( _in_size > _in_capacity || am_empty ) )
+        {
+            auto victim = std::prev( _list.end() );
+            remember( _hash( victim->first ) );
+            _map.erase( victim->first );
+            unlink( victim );
+            return;
+        }
+        auto victim = std::prev( _in );
+        _map.erase( victim->first );
+        unlink( victim );
+    }
+
+    void remember( std::size_t hash )
+    {
+        if( _ghost_capacity == 0 )
+        {
+            return;
+        }
+        auto [it, inserted] = _ghost_map.try_emplace( hash );
+        if( !inserted )
+        {
+            _ghost.splice( _ghost.begin(), _ghost, it->second );
+            return;
+        }
+        try
+        {
+            _ghost.push_front( hash );
+        }
+        catch( ... )
+        {
+            _ghost_map.erase( it );
+            throw;
+        }
+        it->second = _ghost.begin();
+        if( _ghost.size() > _ghost_capacity )
+        {
+            _ghost_map.erase( _ghost.back() );
+            _ghost.pop_back();
+        }
+    }
+
+    template <class _K>
+    iterator get_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return iterator( _list.end() );
+        }
+        touch( it->second );
+
+        return iterator( it->second );
+    }
+
+    template <class _K>
+    bool erase_impl( const _K &key )
+    {
+        auto it = index_find<_Index>( _map, key );
+        if( it == _map.end() )
+        {
+            return false;
+        }
+        unlink( it->second );
+        _map.erase( it );
+        return true;
+    }
+
+    // Removes the entry from `_list` only.
+    void unlink( typename queue_list::iterator pos ) noexcept
+    {
+        if( pos == _in )
+        {
+            ++_in;
+        }
+        if( !pos->is_hot )
+        {
+            --_in_size;
+        }
+        _list.erase( pos );
+    }
+
+    queue_list                    _list;
+    queue_map                     _map;
+    typename queue_list::iterator _in;
+    ghost_list                    _ghost;
+    ghost_map                     _ghost_map;
+    size_t                        _capacity;
+    size_t                        _in_capacity;
+    size_t                        _ghost_capacity;
+    size_t                        _in_size;
+    hasher                        _hash;
+};
+
+// 2Q eviction for `basic_cache`.
+struct two_queue_eviction
+{
+    static constexpr bool storage_aware = false;
+
+    template <class _Key, class _Tp, class _Index, class _Storage, class _Hash,
+              class _KeyEqual>
+    using cache_type = two_queue_cache<_Key, _Tp, _Index, _Hash, _KeyEqual>;
+};
+
+} // namespace cachew
+
+#endif // CACHEW_TWO_QUEUE_CACHE_HPP
@@ -0,0 +1,30 @@
+#ifndef CACHEW_WEIGHER_HPP
+#define CACHEW_WEIGHER_HPP
+
+#include <cstddef>
+#include <limits>
+
+namespace cachew
+{
+
+// The caches bound the total weight of their entries by `max_weight`, on top
+// of the entry count bound. A weigher returns the weight of an entry, it must
+// return the same result for the same entry every time.
+
+// Weight of every entry is 1, the weight of a cache is its size.
+struct unit_weigher
+{
+    template <class _Key, class _Tp>
+    constexpr std::size_t operator()( const _Key & /*key*/,
+                                      const _Tp & /*value*/ ) const noexcept
+    {
+        return 1;
+    }
+};
+
+static constexpr std::size_t UNLIMITED_WEIGHT =
+    std::numeric_limits<std::size_t>::max();
+
+} // namespace cachew
+
+#endif // CACHEW_WEIGHER_HPP
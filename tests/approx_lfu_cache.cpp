@@ -0,0 +1,310 @@
+#include "catch.hpp"
+
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/approx_lfu_cache.hpp>
+#include <cachew/lru_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "Approximate LFU iterator" )
+{
+    approx_lfu_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    CHECK( to_set( cache ) == std::set<int>{11, 22, 33} );
+}
+
+TEST_CASE( "Approximate LFU cache size" )
+{
+    approx_lfu_cache<int, int> cache( 500 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 500 );
+    CHECK( cache.sample_size() == 5 );
+    CHECK( cache.decay_period() == 50'000 );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 500 );
+
+    approx_lfu_cache<int, int> tiny( 1 );
+    tiny.put( 1, 10 );
+    tiny.put( 2, 20 );
+    CHECK( to_set( tiny ) == std::set<int>{20} );
+
+    approx_lfu_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "Approximate LFU counters" )
+{
+    approx_lfu_cache<int, int> cache( 10, 5, 100 );
+
+    cache.put( 1, 10 );
+    CHECK( cache.counter( 1 ) == 5 );
+    CHECK( cache.counter( 2 ) == 0 );
+
+    SECTION( "growth" )
+    {
+        // the epoch does not advance while only key 1 is hit for long
+        approx_lfu_cache<int, int> hot( 10, 5, 100'000'000 );
+        hot.put( 1, 10 );
+        for( int i = 0; i < 10'000; i++ )
+        {
+            hot.get( 1 );
+        }
+        // about 5 + sqrt( 2 * 10'000 / 10 )
+        CHECK( hot.counter( 1 ) > 30 );
+        CHECK( hot.counter( 1 ) < 70 );
+
+        for( int i = 0; i < 2'000'000; i++ )
+        {
+            hot.get( 1 );
+        }
+        CHECK( hot.counter( 1 ) > 200 );
+    }
+
+    SECTION( "decay" )
+    {
+        // every 100 lookups or puts, misses included, are an epoch
+        for( int i = 0; i < 299; i++ )
+        {
+            cache.get( 42 );
+        }
+        CHECK( cache.counter( 1 ) == 2 );
+
+        // a hit applies the decay, then counts
+        cache.get( 1 );
+        CHECK( cache.counter( 1 ) >= 2 );
+        CHECK( cache.counter( 1 ) <= 3 );
+
+        for( int i = 0; i < 1000; i++ )
+        {
+            cache.get( 42 );
+        }
+        CHECK( cache.counter( 1 ) == 0 );
+    }
+}
+
+// The keys hit before the stream of new keys are not sampled as victims
+// while their counters stay above the ones of the new keys.
+TEST_CASE( "Approximate LFU eviction" )
+{
+    approx_lfu_cache<int, int> cache( 100, 5, 1'000'000 );
+
+    for( int key = 0; key < 10; key++ )
+    {
+        cache.put( key, key );
+        for( int i = 0; i < 100; i++ )
+        {
+            cache.get( key );
+        }
+    }
+    for( int key = 100; key < 10'000; key++ )
+    {
+        cache.put( key, key );
+    }
+    CHECK( cache.size() == 100 );
+    for( int key = 0; key < 10; key++ )
+    {
+        CHECK( cache.contains( key ) );
+    }
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 5 ) );
+        CHECK_FALSE( cache.erase( 5 ) );
+        CHECK( cache.size() == 99 );
+
+        // the freed slot is taken first
+        cache.put( 5, 50 );
+        CHECK( cache.size() == 100 );
+        CHECK( *cache.get( 5 ) == 50 );
+        CHECK( cache.contains( 9'999 ) );
+    }
+}
+
+// Keys drawn from a Zipf distribution much wider than the cache.
+TEST_CASE( "Approximate LFU hit ratio" )
+{
+    const size_t cache_size = 500;
+    const int    key_count  = 50'000;
+    const size_t lookups    = 200'000;
+
+    approx_lfu_cache<int, int> lfu( cache_size );
+    lru_cache<int, int>        lru( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    size_t lfu_hits = 0;
+    size_t lru_hits = 0;
+    for( size_t i = 0; i < lookups; i++ )
+    {
+        int key = static_cast<int>( zipf( gen ) );
+        lfu_hits += access( lfu, key );
+        lru_hits += access( lru, key );
+    }
+
+    CHECK( lfu_hits > lru_hits );
+}
+
+TEST_CASE( "Approximate LFU heterogeneous lookup" )
+{
+    approx_lfu_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "Approximate LFU ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    approx_lfu_cache<int, TestType> cache( cache_len );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_set( cache );
+
+    SECTION( "ctors" )
+    {
+        approx_lfu_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_set( cache_new ) == expected );
+
+        // the counters and the random state are copied too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_set( cache_new ) == to_set( cache ) );
+    }
+
+    SECTION( "move" )
+    {
+        approx_lfu_cache<int, TestType> cache_new( std::move( cache ) );
+
+        CHECK( to_set( cache_new ) == expected );
+
+        // the source is left as an empty cache of capacity 0
+        CHECK( cache.size() == 0 );
+        CHECK( cache.capacity() == 0 );
+        cache.clear();
+        cache.put( -1, buff[0] );
+        CHECK( cache.size() == 0 );
+
+        cache = std::move( cache_new );
+        CHECK( to_set( cache ) == expected );
+        CHECK( cache_new.size() == 0 );
+        cache_new.clear();
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == 0 );
+    }
+
+    SECTION( "assignment" )
+    {
+        approx_lfu_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        approx_lfu_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_set( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "approx_lfu_cache erase_if and clear" )
+{
+    approx_lfu_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
@@ -0,0 +1,299 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/arc_cache.hpp>
+#include <cachew/lfu_cache.hpp>
+#include <cachew/lru_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "ARC iterator" )
+{
+    arc_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "ARC cache size" )
+{
+    arc_cache<int, int> cache( 5 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 5 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.size() == 5 );
+    CHECK( cache.recent_size() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+
+    arc_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "ARC adaptation" )
+{
+    arc_cache<int, int> cache( 4 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    cache.get( 1 );
+    CHECK( to_vector( cache ) == std::vector<int>{10, 40, 30, 20} );
+    CHECK( cache.recent_size() == 3 );
+
+    // T1 is over the target, its last entry goes to B1
+    cache.put( 5, 50 );
+    CHECK( to_vector( cache ) == std::vector<int>{10, 50, 40, 30} );
+    CHECK( cache.ghost_size() == 1 );
+
+    // a hit in B1 grows the target and puts the key to T2
+    cache.put( 2, 21 );
+    CHECK( cache.target() == 1 );
+    CHECK( to_vector( cache ) == std::vector<int>{21, 10, 50, 40} );
+    CHECK( cache.recent_size() == 2 );
+
+    cache.put( 6, 60 );
+    CHECK( to_vector( cache ) == std::vector<int>{21, 10, 60, 50} );
+    cache.get( 6 );
+    CHECK( to_vector( cache ) == std::vector<int>{60, 21, 10, 50} );
+
+    // T1 is at the target, the last entry of T2 goes to B2
+    cache.put( 7, 70 );
+    CHECK( to_vector( cache ) == std::vector<int>{60, 21, 70, 50} );
+    CHECK( cache.ghost_size() == 3 );
+
+    // a hit in B2 shrinks the target
+    cache.put( 1, 11 );
+    CHECK( cache.target() == 0 );
+    CHECK( to_vector( cache ) == std::vector<int>{11, 60, 21, 70} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 1 ) );
+        CHECK_FALSE( cache.erase( 1 ) );
+        CHECK( cache.erase( 7 ) );
+        CHECK( to_vector( cache ) == std::vector<int>{60, 21} );
+        CHECK( cache.recent_size() == 0 );
+
+        cache.put( 8, 80 );
+        CHECK( to_vector( cache ) == std::vector<int>{60, 21, 80} );
+    }
+}
+
+// Phases of a hot set mixed with keys seen once, where LFU is better, and of
+// a sliding window of keys, where LRU is better and the frequencies learned
+// by LFU in the previous phase keep stale keys.
+TEST_CASE( "ARC phase-shifting trace" )
+{
+    const int    cache_size   = 100;
+    const int    hot_size     = 60;
+    const int    window_size  = 80;
+    const size_t phase_length = 20'000;
+    const int    phases       = 6;
+
+    arc_cache<int, int> arc( cache_size );
+    lru_cache<int, int> lru( cache_size );
+    lfu_cache<int, int> lfu( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937 gen( 42 );
+    int          cold      = 1'000'000;
+    int          window    = 10'000;
+    size_t       arc_total = 0;
+    size_t       lru_total = 0;
+    size_t       lfu_total = 0;
+    for( int phase = 0; phase < phases; phase++ )
+    {
+        size_t arc_hits = 0;
+        size_t lru_hits = 0;
+        size_t lfu_hits = 0;
+        for( size_t i = 0; i < phase_length; i++ )
+        {
+            int key;
+            if( phase % 2 == 0 )
+            {
+                key = gen() % 3 == 0 ? gen() % hot_size : cold++;
+            }
+            else
+            {
+                if( i % 10 == 0 )
+                {
+                    ++window;
+                }
+                key = window + gen() % window_size;
+            }
+            arc_hits += access( arc, key );
+            lru_hits += access( lru, key );
+            lfu_hits += access( lfu, key );
+        }
+
+        // within 5% of the better policy of the phase
+        CHECK( arc_hits * 20 >= std::max( lru_hits, lfu_hits ) * 19 );
+        arc_total += arc_hits;
+        lru_total += lru_hits;
+        lfu_total += lfu_hits;
+    }
+    CHECK( arc_total > lru_total );
+    CHECK( arc_total > lfu_total );
+}
+
+TEST_CASE( "ARC heterogeneous lookup" )
+{
+    arc_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    cache.put( "two", 22 );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "ARC ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    arc_cache<int, TestType> cache( cache_len );
+
+    // fills T2 and both ghost lists
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_vector( cache );
+    REQUIRE( cache.ghost_size() > 0 );
+
+    SECTION( "ctors" )
+    {
+        arc_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.recent_size() == cache.recent_size() );
+        CHECK( cache_new.ghost_size() == cache.ghost_size() );
+        CHECK( cache_new.target() == cache.target() );
+
+        // the lists are rebuilt too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+        CHECK( cache_new.target() == cache.target() );
+    }
+
+    SECTION( "assignment" )
+    {
+        arc_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        arc_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache.ghost_size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "arc_cache erase_if and clear" )
+{
+    arc_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+    for( int i = 0; i < 100; i += 4 )
+    {
+        cache.get( i );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK( cache.recent_size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.ghost_size() > 0 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.ghost_size() == 0 );
+    CHECK( cache.target() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
@@ -0,0 +1,165 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <set>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <cachew/approx_lfu_cache.hpp>
+#include <cachew/arc_cache.hpp>
+#include <cachew/basic_cache.hpp>
+#include <cachew/clock_cache.hpp>
+#include <cachew/flat_lfu_cache.hpp>
+#include <cachew/gdsf_cache.hpp>
+#include <cachew/lfu_cache.hpp>
+#include <cachew/lirs_cache.hpp>
+#include <cachew/lru_cache.hpp>
+#include <cachew/s3fifo_cache.hpp>
+#include <cachew/sieve_cache.hpp>
+#include <cachew/slru_cache.hpp>
+#include <cachew/tinylfu_cache.hpp>
+#include <cachew/two_queue_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "basic_cache aliases" )
+{
+    CHECK( std::is_same_v<lru_cache<int, int>,
+                          basic_cache<int, int, lru_eviction<>>> );
+    CHECK( std::is_same_v<lfu_cache<int, int, swiss_index>,
+                          basic_cache<int, int, lfu_eviction<>, swiss_index>> );
+    CHECK( std::is_same_v<
+           lru_cache<int, int, slab_storage>::cache_type,
+           lru_cache_impl<int, int, slab_storage, std_index>> );
+    CHECK( std::is_nothrow_constructible_v<lru_cache<int, int>, size_t> );
+}
+
+TEST_CASE( "basic_cache policies" )
+{
+    basic_cache<int, int, clock_eviction, swiss_index> cache( 3 );
+
+    for( int i = 1; i <= 3; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    cache.get( 1 );
+    cache.put( 4, 40 );
+    CHECK( to_set( cache ) == std::set<int>{10, 30, 40} );
+
+    basic_cache<int, int, lru_eviction<>, swiss_index, slab_storage> slab( 2 );
+    slab.put( 1, 10 );
+    slab.put( 2, 20 );
+    slab.get( 1 );
+    slab.put( 3, 30 );
+    CHECK( to_set( slab ) == std::set<int>{10, 30} );
+
+    basic_cache<int, int, lfu_eviction<unit_weigher, std::chrono::steady_clock,
+                                       dynamic_aging>>
+        aging( 2 );
+    aging.put( 1, 10 );
+    aging.get( 1 );
+    aging.put( 2, 20 );
+    aging.put( 3, 30 );
+    CHECK( aging.age() == 1 );
+    CHECK( to_set( aging ) == std::set<int>{10, 30} );
+
+    SECTION( "copy" )
+    {
+        auto copy = cache;
+        copy.put( 5, 50 );
+        CHECK( copy.size() == 3 );
+        CHECK( to_set( cache ) == std::set<int>{10, 30, 40} );
+    }
+}
+
+TEMPLATE_TEST_CASE( "basic_cache capacity 0", "", lru_eviction<>,
+                    lfu_eviction<>, clock_eviction, slru_eviction,
+                    two_queue_eviction, arc_eviction, tinylfu_eviction,
+                    lirs_eviction, s3fifo_eviction, sieve_eviction,
+                    gdsf_eviction<>, flat_lfu_eviction,
+                    approx_lfu_eviction ) // NOLINT
+{
+    // every policy caches nothing
+    basic_cache<int, int, TestType> cache( 0 );
+
+    for( int i = 0; i < 100; i++ )
+    {
+        cache.put( i, i * 10 );
+        cache.put( i, i * 10 );
+        CHECK( cache.get( i ) == cache.end() );
+    }
+    CHECK( cache.size() == 0 );
+    CHECK_FALSE( cache.contains( 1 ) );
+}
+
+TEST_CASE( "basic_cache mutex_sync" )
+{
+    basic_cache<std::string, int, lru_eviction<>, swiss_index, list_storage,
+                mutex_sync>
+        cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+    CHECK( cache.get( std::string_view( "one" ) ) == 1 );
+    CHECK_FALSE( cache.get( "three" ) );
+
+    cache.put( "three", 3 );
+    CHECK( cache.contains( "one" ) );
+    CHECK_FALSE( cache.contains( "two" ) );
+    CHECK( cache.size() == 2 );
+    CHECK( cache.capacity() == 2 );
+
+    auto copy = cache;
+    CHECK( cache.erase( "one" ) );
+    CHECK( copy.contains( "one" ) );
+
+    CHECK( cache.locked( []( auto &c ) { return c.weight(); } ) == 1 );
+    CHECK( cache.erase_if( []( const std::string &, int ) {
+        return true;
+    } ) == 1 );
+    copy.clear();
+    CHECK( copy.size() == 0 );
+}
+
+TEST_CASE( "basic_cache mutex_sync threads" )
+{
+    const size_t threads_count = 4;
+    const int    keys_count    = 10'000;
+
+    basic_cache<int, int, clock_eviction, swiss_index, list_storage,
+                mutex_sync>
+                      cache( 1000 );
+    std::atomic<bool> mismatch{ false };
+
+    std::vector<std::thread> threads;
+    for( size_t t = 0; t < threads_count; ++t )
+    {
+        threads.emplace_back( [&cache, &mismatch, t]() {
+            for( int i = 0; i < keys_count; ++i )
+            {
+                int key = ( i * 7 + static_cast<int>( t ) ) % 2000;
+                cache.put( key, key );
+                auto val = cache.get( key / 2 );
+                if( val && *val != key / 2 )
+                {
+                    mismatch = true;
+                }
+                if( i % 5 == 0 )
+                {
+                    cache.erase( key + 1 );
+                }
+            }
+        } );
+    }
+    for( auto &t : threads )
+    {
+        t.join();
+    }
+
+    CHECK_FALSE( mismatch );
+    CHECK( cache.size() <= cache.capacity() );
+}
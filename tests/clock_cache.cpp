@@ -0,0 +1,249 @@
+#include "catch.hpp"
+
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+
+#include <cachew/clock_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+namespace
+{
+
+// A value whose copy throws if the copied value says so.
+struct throwing_value
+{
+    throwing_value( int v, bool t = false )
+        : value( v )
+        , throws( t )
+    {
+    }
+
+    throwing_value( const throwing_value &other )
+        : value( other.value )
+        , throws( other.throws )
+    {
+        if( throws )
+        {
+            throw std::runtime_error( "copy" );
+        }
+    }
+
+    throwing_value &operator=( const throwing_value & ) = default;
+
+    int  value;
+    bool throws;
+};
+
+} // namespace
+
+TEST_CASE( "CLOCK iterator" )
+{
+    clock_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "CLOCK cache size" )
+{
+    clock_cache<int, int> cache( 5 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 5 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.size() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+}
+
+TEST_CASE( "CLOCK second chance" )
+{
+    clock_cache<int, int> cache( 3 );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 20 );
+    cache.put( 3, 30 );
+
+    // referenced entries survive one sweep of the hand
+    REQUIRE( cache.get( 1 ) != cache.end() );
+    cache.put( 4, 40 );
+    CHECK( to_set( cache ) == std::set<int>{10, 30, 40} );
+
+    cache.put( 5, 50 );
+    CHECK( to_set( cache ) == std::set<int>{10, 40, 50} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 4 ) );
+        CHECK_FALSE( cache.erase( 4 ) );
+        CHECK_FALSE( cache.contains( 4 ) );
+
+        // the freed slot is reused without an eviction
+        cache.put( 6, 60 );
+        CHECK( to_set( cache ) == std::set<int>{10, 50, 60} );
+    }
+}
+
+TEST_CASE( "CLOCK heterogeneous lookup" )
+{
+    clock_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "CLOCK ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    clock_cache<int, TestType> cache( cache_len );
+
+    auto m = buff.begin();
+    std::advance( m, cache_len );
+    std::set<TestType> expected( m, buff.end() );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+    }
+
+    SECTION( "ctors" )
+    {
+        clock_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "move" )
+    {
+        clock_cache<int, TestType> cache_new( std::move( cache ) );
+
+        CHECK( to_set( cache_new ) == expected );
+
+        // the source is left as an empty cache of capacity 0
+        CHECK( cache.size() == 0 );
+        CHECK( cache.capacity() == 0 );
+        cache.clear();
+        cache.put( -1, buff[0] );
+        CHECK( cache.size() == 0 );
+
+        cache = std::move( cache_new );
+        CHECK( to_set( cache ) == expected );
+        CHECK( cache_new.size() == 0 );
+        cache_new.clear();
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == 0 );
+    }
+
+    SECTION( "assignment" )
+    {
+        clock_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        clock_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_set( cache_new ) == expected );
+    }
+}
+
+TEST_CASE( "clock_cache erase_if and clear" )
+{
+    clock_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 11 ) );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
+
+// A put whose value fails to be made leaves its slot free for the next one.
+TEST_CASE( "CLOCK throwing value" )
+{
+    clock_cache<int, throwing_value> cache( 2 );
+
+    throwing_value bad( 3, true );
+    cache.put( 1, throwing_value( 1 ) );
+    cache.put( 2, throwing_value( 2 ) );
+    CHECK_THROWS( cache.put( 3, bad ) );
+    CHECK( cache.size() == 1 );
+    CHECK_FALSE( cache.contains( 3 ) );
+
+    cache.put( 4, throwing_value( 4 ) );
+    CHECK( cache.contains( 2 ) );
+    CHECK( cache.contains( 4 ) );
+
+    for( int i = 5; i < 20; i++ )
+    {
+        cache.put( i, throwing_value( i ) );
+    }
+    CHECK( cache.size() == 2 );
+    CHECK( cache.get( 19 )->value == 19 );
+}
@@ -1,6 +1,10 @@
 #ifndef CACHEW_COMMON_HPP
 #define CACHEW_COMMON_HPP
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
 #include <vector>
 #include <string>
 #include <set>
@@ -14,6 +18,69 @@ std::set<V> to_set(const _Cont &cache) {
     return res;
 }
 
+template<class _Cont, class V = typename _Cont::value_type>
+std::vector<V> to_vector(const _Cont &cache) {
+    std::vector<V> res;
+    for (auto val : cache) {
+        res.emplace_back(val);
+    }
+    return res;
+}
+
+// Weight of an entry is the length of its string value.
+struct string_size_weigher {
+    template<class K>
+    size_t operator()(const K &, const std::string &value) const {
+        return value.size();
+    }
+};
+
+// Clock which is moved by hand, for the TTL tests.
+struct manual_clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        return current;
+    }
+
+    static void advance(duration d) {
+        current += d;
+    }
+
+    static inline time_point current{};
+};
+
+// Integers of [0, n), `k` is drawn with a probability proportional to
+// 1 / (k + 1)^s.
+class zipf_distribution {
+public:
+    zipf_distribution(size_t n, double s) : _cdf(n) {
+        double sum = 0;
+        for (size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            _cdf[k] = sum;
+        }
+        for (auto &c : _cdf) {
+            c /= sum;
+        }
+    }
+
+    template<class Gen>
+    size_t operator()(Gen &gen) {
+        double u = std::uniform_real_distribution<>(0.0, 1.0)(gen);
+        auto it = std::lower_bound(_cdf.begin(), _cdf.end(), u);
+        return std::min<size_t>(it - _cdf.begin(), _cdf.size() - 1);
+    }
+
+private:
+    std::vector<double> _cdf;
+};
+
 template<typename T>
 void gen_test_seq(size_t len, std::vector<T> &res) {
     res.resize(len);
@@ -1,7 +1,10 @@
 #include "catch.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <set>
+#include <string_view>
+#include <thread>
 
 #include <cachew/concurrent_cache.hpp>
 
@@ -9,6 +12,16 @@
 
 using namespace cachew;
 
+namespace
+{
+
+template <class Index, class Tp = int>
+using indexed_cache = concurrent_cache<int, Tp, default_hash<int>,
+                                       default_key_equal<int>, unit_weigher,
+                                       Index>;
+
+} // namespace
+
 TEST_CASE( "concurrent_cache base" )
 {
     concurrent_cache<int, int> cache( 5 );
@@ -21,3 +34,215 @@ TEST_CASE( "concurrent_cache base" )
 
     CHECK( cache.get( 2 ) == 22 );
 }
+
+TEST_CASE( "concurrent_cache eviction" )
+{
+    concurrent_cache<int, int> cache( 3 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.size() == 3 );
+    CHECK( cache.get( 9 ) == 90 );
+    CHECK_FALSE( cache.get( 1 ) );
+
+    cache.put( 9, 99 );
+    CHECK( cache.get( 9 ) == 99 );
+    CHECK( cache.size() == 3 );
+}
+
+TEST_CASE( "concurrent_cache promotion" )
+{
+    concurrent_cache<int, int> cache( 3, UNLIMITED_WEIGHT, unit_weigher(),
+                                      promotion_policy( 0.0 ) );
+    CHECK( cache.promotion().probability() == 0.0 );
+
+    for( int i = 1; i <= 3; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    // a hit does not move the entry, an update does
+    CHECK( cache.get( 1 ) == 10 );
+    cache.put( 4, 40 );
+    CHECK_FALSE( cache.contains( 1 ) );
+
+    cache.put( 2, 22 );
+    cache.put( 5, 50 );
+    CHECK( cache.contains( 2 ) );
+    CHECK_FALSE( cache.contains( 3 ) );
+}
+
+TEMPLATE_TEST_CASE( "concurrent_cache heterogeneous lookup", "", std_index,
+                    swiss_index )
+{
+    concurrent_cache<std::string, int, default_hash<std::string>,
+                     default_key_equal<std::string>, unit_weigher, TestType>
+        cache( 5 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    CHECK( cache.get( key ) == 1 );
+    CHECK_FALSE( cache.get( std::string_view( "three" ) ) );
+    CHECK( cache.contains( key ) );
+    CHECK_FALSE( cache.contains( "three" ) );
+
+    CHECK( cache.erase( key ) );
+    CHECK_FALSE( cache.erase( key ) );
+    CHECK_FALSE( cache.contains( key ) );
+    CHECK( cache.size() == 1 );
+}
+
+TEST_CASE( "concurrent_cache weighted capacity" )
+{
+    concurrent_cache<int, std::string, default_hash<int>,
+                     default_key_equal<int>, string_size_weigher>
+        cache( 100, 10 );
+    CHECK( cache.max_weight() == 10 );
+
+    cache.put( 1, std::string( "aaaa" ) );
+    cache.put( 2, std::string( "bbbb" ) );
+    cache.put( 3, std::string( "ccc" ) );
+    CHECK( cache.weight() <= 10 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.contains( 3 ) );
+
+    cache.put( 3, std::string( 11, 'c' ) );
+    CHECK_FALSE( cache.contains( 3 ) );
+    CHECK( cache.weight() == 4 );
+    CHECK( cache.size() == 1 );
+
+    CHECK( cache.erase( 2 ) );
+    CHECK( cache.weight() == 0 );
+}
+
+TEMPLATE_TEST_CASE( "concurrent_cache try_emplace and get_or_compute", "",
+                    std_index, swiss_index )
+{
+    indexed_cache<TestType, std::string> cache( 2 );
+
+    CHECK( cache.try_emplace( 1, 3, 'a' ) ==
+           std::make_pair( std::string( "aaa" ), true ) );
+    CHECK( cache.try_emplace( 1, 3, 'b' ) ==
+           std::make_pair( std::string( "aaa" ), false ) );
+
+    int calls = 0;
+    auto compute = [&calls]( int key ) {
+        ++calls;
+        return std::to_string( key );
+    };
+    CHECK( cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( calls == 1 );
+
+    cache.get_or_compute( 3, compute );
+    CHECK( cache.size() == 2 );
+    CHECK_FALSE( cache.contains( 1 ) );
+
+    CHECK_THROWS( cache.get_or_compute(
+        4, []( int ) -> std::string { throw std::runtime_error( "" ); } ) );
+    CHECK_FALSE( cache.contains( 4 ) );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "concurrent_cache erase_if and clear", "", std_index,
+                    swiss_index )
+{
+    const int keys_count = 50'000;
+
+    indexed_cache<TestType> cache( keys_count );
+    for( int i = 0; i < keys_count; ++i )
+    {
+        cache.put( i, i );
+    }
+
+    std::atomic<int> calls{ 0 };
+    CHECK( cache.erase_if( [&calls]( int key, int ) {
+        ++calls;
+        return key % 2 == 0;
+    } ) == keys_count / 2 );
+    CHECK( calls == keys_count );
+    CHECK( cache.size() == keys_count / 2 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( cache.get( 11 ) == 11 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK_FALSE( cache.contains( 11 ) );
+
+    for( int i = 0; i < 10; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.erase_if( []( int, int value ) { return value < 5; } ) == 5 );
+    CHECK( cache.size() == 5 );
+}
+
+TEST_CASE( "concurrent_cache resize" )
+{
+    concurrent_cache<int, int> cache( 1000 );
+    for( int i = 0; i < 1000; ++i )
+    {
+        cache.put( i, i );
+    }
+
+    cache.resize( 100 );
+    CHECK( cache.capacity() == 100 );
+    CHECK( cache.size() == 1000 );
+    cache.put( 1000, 1000 );
+    CHECK( cache.size() < 1000 );
+    CHECK( cache.size() > 100 );
+    for( int i = 1001; cache.size() > 100; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+
+    cache.resize( 200 );
+    for( int i = 0; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 200 );
+}
+
+TEMPLATE_TEST_CASE( "concurrent_cache threads", "", std_index, swiss_index )
+{
+    const size_t threads_count = 4;
+    const int    keys_count    = 10'000;
+
+    indexed_cache<TestType> cache( 1000 );
+    std::atomic<bool>       mismatch{ false };
+
+    std::vector<std::thread> threads;
+    for( size_t t = 0; t < threads_count; ++t )
+    {
+        threads.emplace_back( [&cache, &mismatch, t]() {
+            for( int i = 0; i < keys_count; ++i )
+            {
+                int key = ( i * 7 + static_cast<int>( t ) ) % 2000;
+                cache.put( key, key );
+                auto val = cache.get( key / 2 );
+                if( val && *val != key / 2 )
+                {
+                    mismatch = true;
+                }
+                if( i % 5 == 0 )
+                {
+                    cache.erase( key + 1 );
+                }
+            }
+        } );
+    }
+    for( auto &t : threads )
+    {
+        t.join();
+    }
+
+    CHECK_FALSE( mismatch );
+    CHECK( cache.size() <= cache.capacity() );
+}
@@ -0,0 +1,267 @@
+#include "catch.hpp"
+
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/flat_lfu_cache.hpp>
+#include <cachew/lfu_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "Flat LFU iterator" )
+{
+    flat_lfu_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    CHECK( to_set( cache ) == std::set<int>{11, 22, 33} );
+}
+
+TEST_CASE( "Flat LFU cache size" )
+{
+    flat_lfu_cache<int, int> cache( 3 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.size() == 3 );
+    CHECK( cache.capacity() == 3 );
+
+    cache.get( 8 );
+    CHECK( to_set( cache ) == std::set<int>{70, 80, 90} );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 20 );
+    CHECK( to_set( cache ) == std::set<int>{10, 20, 80} );
+
+    flat_lfu_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "Flat LFU buckets" )
+{
+    flat_lfu_cache<int, int> cache( 4 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.bucket_count() == 1 );
+
+    // 1 moves to a new bucket, 2 relabels its own bucket
+    cache.get( 1 );
+    cache.get( 2 );
+    CHECK( cache.bucket_count() == 2 );
+    cache.get( 2 );
+    CHECK( cache.bucket_count() == 3 );
+
+    // the oldest entry of the lowest frequency goes first
+    cache.put( 5, 50 );
+    CHECK( to_set( cache ) == std::set<int>{10, 20, 40, 50} );
+    cache.put( 6, 60 );
+    CHECK( to_set( cache ) == std::set<int>{10, 20, 50, 60} );
+
+    // buckets are freed with their last entries
+    cache.erase( 2 );
+    cache.erase( 1 );
+    CHECK( cache.bucket_count() == 1 );
+    cache.erase( 5 );
+    cache.erase( 6 );
+    CHECK( cache.bucket_count() == 0 );
+    CHECK( cache.size() == 0 );
+
+    cache.put( 7, 70 );
+    CHECK( *cache.get( 7 ) == 70 );
+}
+
+// Same eviction order as lfu_cache.
+TEST_CASE( "Flat LFU matches lfu_cache" )
+{
+    const size_t cache_size = 100;
+
+    flat_lfu_cache<int, int> flat( cache_size );
+    lfu_cache<int, int>      lfu( cache_size );
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( 1000, 0.8 );
+
+    for( int i = 0; i < 100'000; i++ )
+    {
+        int key = static_cast<int>( zipf( gen ) );
+        switch( i % 7 )
+        {
+        case 0:
+            flat.erase( key );
+            lfu.erase( key );
+            break;
+        case 1:
+        case 2:
+            flat.put( key, i );
+            lfu.put( key, i );
+            break;
+        default:
+            if( flat.get( key ) == flat.end() )
+            {
+                flat.put( key, i );
+                lfu.put( key, i );
+            }
+            else
+            {
+                lfu.get( key );
+            }
+        }
+    }
+    CHECK( to_set( flat ) == to_set( lfu ) );
+    CHECK( flat.bucket_count() <= flat.size() );
+}
+
+TEST_CASE( "Flat LFU heterogeneous lookup" )
+{
+    flat_lfu_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    CHECK( cache.contains( "one" ) );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "Flat LFU ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    flat_lfu_cache<int, TestType> cache( cache_len );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_set( cache );
+
+    SECTION( "ctors" )
+    {
+        flat_lfu_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_set( cache_new ) == expected );
+        CHECK( cache_new.bucket_count() == cache.bucket_count() );
+
+        // the frequencies are copied too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_set( cache_new ) == to_set( cache ) );
+    }
+
+    SECTION( "move" )
+    {
+        flat_lfu_cache<int, TestType> cache_new( std::move( cache ) );
+
+        CHECK( to_set( cache_new ) == expected );
+
+        // the source is left as an empty cache of capacity 0
+        CHECK( cache.size() == 0 );
+        CHECK( cache.capacity() == 0 );
+        cache.clear();
+        cache.put( -1, buff[0] );
+        CHECK( cache.size() == 0 );
+
+        cache = std::move( cache_new );
+        CHECK( to_set( cache ) == expected );
+        CHECK( cache_new.size() == 0 );
+        cache_new.clear();
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == 0 );
+    }
+
+    SECTION( "assignment" )
+    {
+        flat_lfu_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        flat_lfu_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_set( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "flat_lfu_cache erase_if and clear" )
+{
+    flat_lfu_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+        cache.get( i - i % 3 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.bucket_count() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
@@ -0,0 +1,92 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include <cachew/frequency_sketch.hpp>
+
+using namespace cachew;
+
+TEST_CASE( "frequency_sketch base" )
+{
+    frequency_sketch sketch( 64 );
+
+    CHECK( sketch.frequency( 1 ) == 0 );
+
+    // the first access only sets the doorkeeper
+    sketch.increment( 1 );
+    CHECK( sketch.frequency( 1 ) == 1 );
+
+    for( int i = 0; i < 5; i++ )
+    {
+        sketch.increment( 1 );
+    }
+    CHECK( sketch.frequency( 1 ) == 6 );
+
+    for( int i = 0; i < 100; i++ )
+    {
+        sketch.increment( 2 );
+    }
+    CHECK( sketch.frequency( 2 ) == frequency_sketch::MAX_FREQUENCY );
+
+    sketch.clear();
+    CHECK( sketch.frequency( 1 ) == 0 );
+    CHECK( sketch.frequency( 2 ) == 0 );
+}
+
+TEST_CASE( "frequency_sketch estimates" )
+{
+    const size_t capacity = 1024;
+
+    frequency_sketch sketch( capacity );
+    std::mt19937     gen( 42 );
+
+    // fewer accesses than the halving period
+    std::map<size_t, unsigned> counts;
+    for( size_t i = 0; i < 5 * capacity; i++ )
+    {
+        size_t key = gen() % capacity;
+        sketch.increment( key );
+        ++counts[key];
+    }
+
+    size_t exact = 0;
+    for( auto [key, count] : counts )
+    {
+        unsigned expected =
+            std::min<unsigned>( count, frequency_sketch::MAX_FREQUENCY );
+        CHECK( sketch.frequency( key ) >= expected );
+        exact += sketch.frequency( key ) == expected;
+    }
+    CHECK( exact * 4 >= counts.size() * 3 );
+
+    // 3 bytes per entry of capacity
+    CHECK( sketch.memory_size() == 3 * capacity );
+}
+
+TEST_CASE( "frequency_sketch halving" )
+{
+    frequency_sketch sketch( 64 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        sketch.increment( 1 );
+    }
+    for( int i = 0; i < 600; i++ )
+    {
+        sketch.increment( 2 );
+    }
+    CHECK( sketch.frequency( 1 ) == 10 );
+    CHECK( sketch.frequency( 2 ) == frequency_sketch::MAX_FREQUENCY );
+
+    // the 640th access halves the counters and clears the doorkeeper before
+    // it is counted
+    for( int i = 0; i < 30; i++ )
+    {
+        sketch.increment( 3 );
+    }
+    CHECK( sketch.frequency( 1 ) == 4 );
+    CHECK( sketch.frequency( 2 ) == 7 );
+    CHECK( sketch.frequency( 3 ) == 8 );
+}
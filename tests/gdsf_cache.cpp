@@ -0,0 +1,300 @@
+#include "catch.hpp"
+
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/gdsf_cache.hpp>
+#include <cachew/lfu_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+namespace
+{
+
+// Cost of an entry is its value.
+struct value_cost
+{
+    double operator()( int /*key*/, int value ) const
+    {
+        return value;
+    }
+};
+
+using string_gdsf_cache =
+    gdsf_cache<int, std::string, std_index, default_hash<int>,
+               default_key_equal<int>, string_size_weigher>;
+
+} // namespace
+
+TEST_CASE( "GDSF iterator" )
+{
+    gdsf_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    // from the lowest priority
+    CHECK( to_vector( cache ) == std::vector<int>{22, 33, 11} );
+}
+
+TEST_CASE( "GDSF cache size" )
+{
+    gdsf_cache<int, int> cache( 5 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 5 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.size() == 5 );
+    CHECK( cache.weight() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+
+    gdsf_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+// A heavy entry hit twice outranks light ones hit once in lfu_cache, but
+// not in gdsf_cache.
+TEST_CASE( "GDSF weighted capacity" )
+{
+    string_gdsf_cache cache( 100, 100 );
+    lfu_cache<int, std::string, std_index, default_hash<int>,
+              default_key_equal<int>, string_size_weigher>
+        lfu( 100, 100 );
+
+    auto put = [&]( int key, const std::string &value ) {
+        cache.put( key, value );
+        lfu.put( key, value );
+    };
+
+    put( 0, std::string( 60, 'b' ) );
+    cache.get( 0 );
+    lfu.get( 0 );
+    for( int i = 1; i <= 8; i++ )
+    {
+        put( i, std::string( 5, 's' ) );
+    }
+    CHECK( cache.weight() == 100 );
+
+    put( 9, std::string( 5, 's' ) );
+    CHECK_FALSE( cache.contains( 0 ) );
+    CHECK( cache.size() == 9 );
+    CHECK( cache.weight() == 45 );
+    CHECK( cache.inflation() == Approx( 2.0 / 60 ) );
+
+    CHECK( lfu.contains( 0 ) );
+    CHECK_FALSE( lfu.contains( 1 ) );
+
+    // too heavy entries are not cached
+    cache.put( 10, std::string( 101, 'x' ) );
+    CHECK_FALSE( cache.contains( 10 ) );
+    cache.put( 1, std::string( 101, 'x' ) );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.weight() == 40 );
+
+    // an update weighs the entry again
+    cache.put( 2, std::string( 20, 'u' ) );
+    CHECK( cache.weight() == 55 );
+    CHECK( cache.size() == 8 );
+
+    // the updated entry is the heaviest, so it has the lowest priority
+    cache.put( 3, std::string( 61, 'u' ) );
+    CHECK_FALSE( cache.contains( 3 ) );
+    CHECK( cache.weight() == 50 );
+    CHECK( cache.size() == 7 );
+
+    // a moved-from cache is empty, weighs nothing and starts a new clock
+    auto moved = std::move( cache );
+    CHECK( moved.weight() == 50 );
+    CHECK( cache.size() == 0 );
+    CHECK( cache.weight() == 0 );
+    CHECK( cache.inflation() == 0 );
+    cache.put( 11, std::string( 100, 'm' ) );
+    CHECK( cache.weight() == 100 );
+    CHECK( cache.contains( 11 ) );
+}
+
+// The inflation clock rises with every eviction, so a key which is no longer
+// hit falls behind the new ones.
+TEST_CASE( "GDSF inflation" )
+{
+    gdsf_cache<int, int> cache( 3 );
+
+    cache.put( 1, 10 );
+    for( int i = 0; i < 5; i++ )
+    {
+        cache.get( 1 );
+    }
+    for( int i = 2; i <= 13; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.contains( 1 ) );
+    CHECK( cache.inflation() == Approx( 5.0 ) );
+
+    // key 1 is the oldest of the keys of priority 6
+    cache.put( 14, 140 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.inflation() == Approx( 6.0 ) );
+    CHECK( to_vector( cache ) == std::vector<int>{120, 130, 140} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 12 ) );
+        CHECK_FALSE( cache.erase( 12 ) );
+        CHECK( cache.size() == 2 );
+
+        // a new key starts from the inflation clock
+        cache.put( 15, 150 );
+        cache.get( 13 );
+        CHECK( to_vector( cache ) == std::vector<int>{140, 150, 130} );
+    }
+}
+
+TEST_CASE( "GDSF cost" )
+{
+    gdsf_cache<int, int, std_index, default_hash<int>, default_key_equal<int>,
+               unit_weigher, value_cost>
+        cache( 2 );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 1 );
+    cache.put( 3, 5 );
+    CHECK( to_vector( cache ) == std::vector<int>{5, 10} );
+    CHECK( cache.inflation() == Approx( 1.0 ) );
+}
+
+TEST_CASE( "GDSF heterogeneous lookup" )
+{
+    gdsf_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    CHECK( cache.contains( "one" ) );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "GDSF ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    gdsf_cache<int, TestType> cache( cache_len );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_vector( cache );
+    REQUIRE( cache.inflation() > 0 );
+
+    SECTION( "ctors" )
+    {
+        gdsf_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.inflation() == cache.inflation() );
+
+        // the priorities are copied too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+    }
+
+    SECTION( "assignment" )
+    {
+        gdsf_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        gdsf_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "gdsf_cache erase_if and clear" )
+{
+    string_gdsf_cache cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, std::to_string( i ) );
+    }
+    CHECK( cache.weight() == 190 );
+
+    CHECK( cache.erase_if( []( int key, const std::string & ) {
+        return key % 2 == 0;
+    } ) == 50 );
+    CHECK( cache.size() == 50 );
+    CHECK( cache.weight() == 95 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == "11" );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, std::to_string( i ) );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.inflation() > 0 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.weight() == 0 );
+    CHECK( cache.inflation() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, std::to_string( i ) );
+    }
+    CHECK( cache.size() == 100 );
+}
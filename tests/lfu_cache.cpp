@@ -1,7 +1,10 @@
 #include "catch.hpp"
 
 #include <iostream>
+#include <random>
 #include <set>
+#include <stdexcept>
+#include <string_view>
 
 #include <cachew/lfu_cache.hpp>
 
@@ -9,6 +12,39 @@
 
 using namespace cachew;
 
+namespace
+{
+
+using aging_lfu_cache =
+    lfu_cache<int, int, std_index, default_hash<int>, default_key_equal<int>,
+              unit_weigher, std::chrono::steady_clock, dynamic_aging>;
+
+// A value whose assignment throws if the assigned value says so.
+struct throwing_value
+{
+    throwing_value( int v, bool t = false )
+        : value( v )
+        , throws( t )
+    {
+    }
+    throwing_value( const throwing_value & ) = default;
+
+    throwing_value &operator=( const throwing_value &other )
+    {
+        if( other.throws )
+        {
+            throw std::runtime_error( "assignment" );
+        }
+        value = other.value;
+        return *this;
+    }
+
+    int  value;
+    bool throws;
+};
+
+} // namespace
+
 TEST_CASE( "LFU cache size" )
 {
     static const size_t cache_size = 3;
@@ -100,3 +136,544 @@ TEMPLATE_TEST_CASE( "LFU ctors and assignment", "", int, double,
         CHECK( to_set( cache_new ) == expected );
     }
 }
+
+TEST_CASE( "LFU swiss index" )
+{
+    lfu_cache<int, int, swiss_index> cache( 3 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    REQUIRE( cache.size() == 3 );
+
+    REQUIRE( cache.get( 8 ) != cache.end() );
+    CHECK( cache.get( 1 ) == cache.end() );
+    CHECK( to_set( cache ) == std::set<int>{70, 80, 90} );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 20 );
+    CHECK( to_set( cache ) == std::set<int>{10, 20, 80} );
+}
+
+TEST_CASE( "LFU heterogeneous lookup" )
+{
+    lfu_cache<std::string, int, swiss_index> cache( 3 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+    cache.put( "three", 3 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.get( std::string_view( "four" ) ) == cache.end() );
+
+    CHECK( cache.contains( key ) );
+    CHECK_FALSE( cache.contains( "four" ) );
+
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK_FALSE( cache.erase( "two" ) );
+    CHECK( cache.size() == 2 );
+
+    cache.put( "four", 4 );
+    cache.put( "five", 5 );
+    CHECK( to_set( cache ) == std::set<int>{1, 4, 5} );
+}
+
+TEST_CASE( "LFU weighted capacity" )
+{
+    lfu_cache<int, std::string, std_index, default_hash<int>,
+              default_key_equal<int>, string_size_weigher>
+        cache( 100, 10 );
+    CHECK( cache.max_weight() == 10 );
+
+    cache.put( 1, std::string( "aaaa" ) );
+    cache.put( 2, std::string( "bbbb" ) );
+    cache.put( 3, std::string( "cc" ) );
+    CHECK( cache.weight() == 10 );
+
+    // the least frequently used entries are evicted until the new one fits
+    cache.get( 1 );
+    cache.get( 3 );
+    cache.put( 4, std::string( "ddd" ) );
+    CHECK( cache.weight() == 9 );
+    CHECK_FALSE( cache.contains( 2 ) );
+    CHECK( cache.contains( 1 ) );
+    CHECK( cache.contains( 3 ) );
+
+    // `1` and `3` are used as often as `4`, but less recently
+    cache.put( 4, std::string( "ddddd" ) );
+    CHECK( cache.weight() == 7 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.contains( 4 ) );
+
+    cache.put( 5, std::string( 11, 'e' ) );
+    CHECK_FALSE( cache.contains( 5 ) );
+    cache.put( 4, std::string( 11, 'd' ) );
+    CHECK_FALSE( cache.contains( 4 ) );
+
+    CHECK( cache.weight() == 2 );
+
+    CHECK( cache.erase( 3 ) );
+    CHECK( cache.weight() == 0 );
+
+    // a moved-from cache is empty and weighs nothing
+    cache.put( 6, std::string( "ffff" ) );
+    auto moved = std::move( cache );
+    CHECK( moved.weight() == 4 );
+    CHECK( cache.size() == 0 );
+    CHECK( cache.weight() == 0 );
+    cache.put( 7, std::string( 10, 'g' ) );
+    CHECK( cache.weight() == 10 );
+    CHECK( cache.contains( 7 ) );
+}
+
+TEST_CASE( "LFU TTL" )
+{
+    using ttl_cache =
+        lfu_cache<int, int, std_index, default_hash<int>,
+                  default_key_equal<int>, unit_weigher, manual_clock>;
+    using std::chrono::milliseconds;
+
+    ttl_cache cache( 10 );
+
+    cache.put( 1, 11, milliseconds( 100 ) );
+    cache.put( 2, 22, milliseconds( 200 ) );
+    cache.put( 3, 33 );
+    CHECK( cache.get( 1 ) != cache.end() );
+
+    manual_clock::advance( milliseconds( 100 ) );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.get( 1 ) == cache.end() );
+    CHECK( cache.size() == 2 );
+
+    ttl_cache copy( cache );
+
+    cache.put( 2, 222 );
+    manual_clock::advance( milliseconds( 1000 ) );
+    cache.expire();
+    CHECK( *cache.get( 2 ) == 222 );
+    CHECK( cache.size() == 2 );
+
+    // the copy has its own timers
+    copy.expire();
+    CHECK( copy.size() == 1 );
+    CHECK( copy.contains( 3 ) );
+
+    for( int i = 0; i < 20; ++i )
+    {
+        cache.put( 10 + i, i, milliseconds( 50 ) );
+    }
+    CHECK( cache.size() == 10 );
+    manual_clock::advance( milliseconds( 50 ) );
+    cache.put( 4, 44 );
+    CHECK( cache.size() <= 3 );
+    CHECK( cache.contains( 4 ) );
+}
+
+TEST_CASE( "LFU try_emplace and get_or_compute" )
+{
+    lfu_cache<int, std::string> cache( 2 );
+
+    auto [it, inserted] = cache.try_emplace( 1, 3, 'a' );
+    CHECK( inserted );
+    CHECK( *it == "aaa" );
+
+    std::tie( it, inserted ) = cache.try_emplace( 1, 3, 'b' );
+    CHECK_FALSE( inserted );
+    CHECK( *it == "aaa" );
+
+    int calls = 0;
+    auto compute = [&calls]( int key ) {
+        ++calls;
+        return std::to_string( key );
+    };
+    CHECK( *cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( *cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( calls == 1 );
+
+    // hits count as uses, `1` is used less often than `2`
+    cache.get_or_compute( 3, compute );
+    CHECK( cache.size() == 2 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.contains( 2 ) );
+
+    CHECK_THROWS( cache.try_emplace(
+        4, []() -> std::string { throw std::runtime_error( "" ); }() ) );
+    CHECK_FALSE( cache.contains( 4 ) );
+    CHECK( cache.size() == 2 );
+}
+
+TEST_CASE( "LFU erase_if and clear" )
+{
+    lfu_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+        if( i % 3 == 0 )
+        {
+            cache.get( i );
+        }
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    // eviction still picks the least frequently used entries
+    for( int i = 100; i < 160; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 3 ) );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    cache.put( 1, 1 );
+    CHECK( *cache.get( 1 ) == 1 );
+}
+
+TEST_CASE( "LFU resize" )
+{
+    lfu_cache<int, int> cache( 1000 );
+    for( int i = 0; i < 1000; ++i )
+    {
+        cache.put( i, i );
+    }
+    cache.get( 5 );
+
+    cache.resize( 100 );
+    CHECK( cache.capacity() == 100 );
+    CHECK( cache.size() == 1000 );
+    cache.put( 1000, 1000 );
+    CHECK( cache.size() < 1000 );
+    CHECK( cache.size() > 100 );
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.get( 1000 );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 5 ) );
+
+    cache.resize( 200 );
+    for( int i = 2000; i < 2200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 200 );
+
+    SECTION( "resize( 0 )" )
+    {
+        // nothing is cached at capacity 0, as in lru_cache
+        cache.resize( 0 );
+        for( int i = 3000; i < 4000; ++i )
+        {
+            cache.put( i, i );
+        }
+        CHECK( cache.size() == 0 );
+        CHECK( cache.begin() == cache.end() );
+        CHECK_FALSE( cache.try_emplace( 1, 1 ).second );
+        CHECK( cache.size() == 0 );
+    }
+}
+
+TEST_CASE( "LFU dynamic aging" )
+{
+    aging_lfu_cache     cache( 3 );
+    lfu_cache<int, int> plain( 3 );
+
+    auto put = [&]( int key ) {
+        cache.put( key, key * 10 );
+        plain.put( key, key * 10 );
+    };
+
+    put( 1 );
+    for( int i = 0; i < 4; i++ )
+    {
+        cache.get( 1 );
+        plain.get( 1 );
+    }
+    for( int i = 2; i <= 11; i++ )
+    {
+        put( i );
+    }
+    CHECK( cache.contains( 1 ) );
+    CHECK( cache.age() == 4 );
+
+    // the new keys reach the frequency of key 1, which is the oldest of them
+    put( 12 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.age() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{100, 110, 120} );
+
+    CHECK( plain.contains( 1 ) );
+    CHECK( plain.age() == 0 );
+
+    SECTION( "copy" )
+    {
+        aging_lfu_cache cache_new( cache );
+
+        CHECK( cache_new.age() == cache.age() );
+        cache_new.put( 13, 130 );
+        cache.put( 13, 130 );
+        CHECK( to_set( cache_new ) == to_set( cache ) );
+    }
+
+    SECTION( "move" )
+    {
+        aging_lfu_cache cache_new( std::move( cache ) );
+
+        CHECK( cache_new.age() == 5 );
+        CHECK( cache.age() == 0 );
+        cache.put( 13, 130 );
+        CHECK( to_set( cache ) == std::set<int>{130} );
+    }
+
+    SECTION( "clear" )
+    {
+        cache.clear();
+        CHECK( cache.age() == 0 );
+
+        cache.put( 1, 10 );
+        cache.get( 1 );
+        cache.put( 2, 20 );
+        cache.put( 3, 30 );
+        cache.put( 4, 40 );
+        CHECK( to_set( cache ) == std::set<int>{10, 30, 40} );
+    }
+}
+
+// The hot keys move to another range half way, lfu_cache keeps the old hot
+// keys for their high frequencies while the aging one lets them go.
+TEST_CASE( "LFU dynamic aging hit ratio" )
+{
+    const size_t cache_size = 500;
+    const int    key_count  = 50'000;
+    const size_t lookups    = 100'000;
+
+    aging_lfu_cache     aging( cache_size );
+    lfu_cache<int, int> plain( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    size_t aging_hits = 0;
+    size_t plain_hits = 0;
+    for( int shift : {0, key_count} )
+    {
+        aging_hits = 0;
+        plain_hits = 0;
+        for( size_t i = 0; i < lookups; i++ )
+        {
+            int key = static_cast<int>( zipf( gen ) ) + shift;
+            aging_hits += access( aging, key );
+            plain_hits += access( plain, key );
+        }
+    }
+
+    CHECK( aging_hits > plain_hits * 2 );
+}
+
+TEST_CASE( "LFU frequency nodes" )
+{
+    lfu_cache<int, int> cache( 4 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.bucket_count() == 1 );
+
+    // 1 moves to a new node, 2 relabels its own node
+    cache.get( 1 );
+    cache.get( 2 );
+    CHECK( cache.bucket_count() == 2 );
+    cache.get( 2 );
+    CHECK( cache.bucket_count() == 3 );
+
+    // the oldest entry of the lowest frequency goes first
+    cache.put( 5, 50 );
+    cache.put( 6, 60 );
+    CHECK( to_set( cache ) == std::set<int>{10, 20, 50, 60} );
+
+    // nodes go with their last entries
+    cache.erase( 2 );
+    CHECK( cache.bucket_count() == 2 );
+    CHECK( cache.erase_if( []( int key, int ) { return key > 4; } ) == 2 );
+    CHECK( cache.bucket_count() == 1 );
+    cache.erase( 1 );
+    CHECK( cache.bucket_count() == 0 );
+
+    // a hot key does not leave a node per hit behind
+    cache.put( 7, 70 );
+    for( int i = 0; i < 1000; i++ )
+    {
+        cache.get( 7 );
+    }
+    CHECK( cache.bucket_count() == 1 );
+
+    SECTION( "too heavy update" )
+    {
+        lfu_cache<int, std::string, std_index, default_hash<int>,
+                  default_key_equal<int>, string_size_weigher>
+            weighted( 4, 10 );
+        weighted.put( 1, "one" );
+        weighted.put( 2, "two" );
+        weighted.get( 1 );
+        weighted.put( 1, std::string( 11, 'x' ) );
+        CHECK_FALSE( weighted.contains( 1 ) );
+        CHECK( weighted.bucket_count() == 1 );
+    }
+
+    SECTION( "throwing update" )
+    {
+        lfu_cache<int, throwing_value> values( 4 );
+        values.put( 1, throwing_value( 10 ) );
+        values.put( 2, throwing_value( 20 ) );
+        values.get( 2 );
+
+        // the node of 1 is dropped as it joins the node of 2
+        CHECK_THROWS( values.put( 1, throwing_value( 11, true ) ) );
+        CHECK( values.bucket_count() == 1 );
+        CHECK( values.get( 1 )->value == 10 );
+        CHECK( values.erase( 1 ) );
+        CHECK( values.size() == 1 );
+    }
+}
+
+// An entry which expired before its timer fired is replaced by try_emplace,
+// its node goes with it.
+TEST_CASE( "LFU try_emplace of an expired entry" )
+{
+    using ttl_cache =
+        lfu_cache<int, int, std_index, default_hash<int>,
+                  default_key_equal<int>, unit_weigher, manual_clock>;
+    using std::chrono::milliseconds;
+
+    ttl_cache cache( 2 );
+
+    cache.put( 9, 9 );
+    cache.get( 9 );
+    cache.get( 9 );
+    cache.put( 1, 1 );
+    cache.put( 1, 1, milliseconds( 0 ) );
+
+    CHECK( cache.try_emplace( 1, 11 ).second );
+    CHECK( cache.bucket_count() == 2 );
+    CHECK( cache.erase( 1 ) );
+    CHECK( cache.bucket_count() == 1 );
+
+    cache.resize( 1 );
+    cache.put( 5, 5 );
+    CHECK( cache.size() == 1 );
+    CHECK( cache.contains( 5 ) );
+    CHECK( cache.bucket_count() == 1 );
+}
+
+TEST_CASE( "LFU top_k and frequency_histogram" )
+{
+    using key_frequency = std::pair<int, size_t>;
+    using histogram     = std::vector<std::pair<size_t, size_t>>;
+
+    lfu_cache<int, int> cache( 10 );
+
+    CHECK( cache.top_k( 3 ).empty() );
+    CHECK( cache.frequency_histogram().empty() );
+
+    for( int key = 1; key <= 6; key++ )
+    {
+        cache.put( key, key * 10 );
+        for( int i = 1; i < key % 4; i++ )
+        {
+            cache.get( key );
+        }
+    }
+
+    // frequencies: 1 -> 1, 2 -> 2, 3 -> 3, 4 -> 1, 5 -> 1, 6 -> 2
+    CHECK( cache.top_k( 3 ) ==
+           std::vector<key_frequency>{{3, 3}, {6, 2}, {2, 2}} );
+    CHECK( cache.top_k( 0 ).empty() );
+    CHECK( cache.top_k( 100 ).size() == 6 );
+    CHECK( cache.frequency_histogram() == histogram{{1, 3}, {2, 2}, {3, 1}} );
+
+    cache.get( 3 );
+    cache.erase( 6 );
+    CHECK( cache.top_k( 2 ) == std::vector<key_frequency>{{3, 4}, {2, 2}} );
+    CHECK( cache.frequency_histogram() == histogram{{1, 3}, {2, 1}, {4, 1}} );
+
+    SECTION( "TTL" )
+    {
+        using ttl_cache =
+            lfu_cache<int, int, std_index, default_hash<int>,
+                      default_key_equal<int>, unit_weigher, manual_clock>;
+
+        ttl_cache ttl( 10 );
+        ttl.put( 1, 10, std::chrono::milliseconds( 100 ) );
+        ttl.get( 1 );
+        ttl.put( 2, 20 );
+
+        manual_clock::advance( std::chrono::milliseconds( 100 ) );
+
+        // expired entries are not reported, but still counted
+        CHECK( ttl.top_k( 2 ) == std::vector<key_frequency>{{2, 1}} );
+        CHECK( ttl.frequency_histogram() == histogram{{1, 1}, {2, 1}} );
+        ttl.expire();
+        CHECK( ttl.frequency_histogram() == histogram{{1, 1}} );
+    }
+}
+
+TEST_CASE( "LFU promotion" )
+{
+    using key_frequency = std::pair<int, size_t>;
+    using histogram     = std::vector<std::pair<size_t, size_t>>;
+
+    lfu_cache<int, int> cache( 10 );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 20 );
+
+    SECTION( "min_age" )
+    {
+        cache.set_promotion( promotion_policy( 1.0, 2 ) );
+
+        // 2 was added last, 1 one addition before it
+        cache.get( 2 );
+        cache.get( 1 );
+        cache.put( 3, 30 );
+        cache.get( 1 );
+        CHECK( cache.frequency_histogram() == histogram{{1, 2}, {2, 1}} );
+    }
+
+    SECTION( "probability" )
+    {
+        cache.set_promotion( promotion_policy( 0.0 ) );
+
+        for( int i = 0; i < 10; i++ )
+        {
+            REQUIRE( cache.get( 1 ) != cache.end() );
+        }
+        CHECK( cache.try_emplace( 2, 0 ).first != cache.end() );
+        CHECK( cache.frequency_histogram() == histogram{{1, 2}} );
+
+        // an update always counts
+        cache.put( 2, 22 );
+        CHECK( cache.top_k( 1 ) == std::vector<key_frequency>{{2, 2}} );
+    }
+}
@@ -0,0 +1,322 @@
+#include "catch.hpp"
+
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lirs_cache.hpp>
+#include <cachew/lru_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "LIRS iterator" )
+{
+    lirs_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "LIRS cache size" )
+{
+    lirs_cache<int, int> cache( 500 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 500 );
+    CHECK( cache.hir_capacity() == 5 );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 500 );
+    CHECK( cache.lir_size() == 495 );
+
+    lirs_cache<int, int> tiny( 1 );
+    tiny.put( 1, 10 );
+    tiny.put( 2, 20 );
+    tiny.put( 1, 11 );
+    tiny.get( 1 );
+    CHECK( to_set( tiny ) == std::set<int>{11} );
+    CHECK( tiny.lir_size() == 0 );
+
+    lirs_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "LIRS stack and queue" )
+{
+    lirs_cache<int, int> cache( 5, 2 );
+
+    // the LIR set is filled first, then the HIR queue
+    for( int i = 1; i <= 5; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( to_vector( cache ) == std::vector<int>{30, 20, 10, 40, 50} );
+    CHECK( cache.lir_size() == 3 );
+
+    // the queue front is evicted and stays in the stack
+    cache.put( 6, 60 );
+    CHECK( to_vector( cache ) == std::vector<int>{30, 20, 10, 50, 60} );
+    CHECK( cache.ghost_size() == 1 );
+
+    // a non-resident key in the stack comes back as LIR, the stack bottom
+    // becomes HIR and the stack is pruned down to a LIR key
+    cache.put( 4, 41 );
+    CHECK( to_vector( cache ) == std::vector<int>{41, 30, 20, 60, 10} );
+    CHECK( cache.lir_size() == 3 );
+    CHECK( cache.ghost_size() == 1 );
+
+    // a HIR key hit out of the stack stays HIR
+    cache.get( 10 );
+    CHECK( to_vector( cache ) == std::vector<int>{41, 30, 20, 60, 10} );
+
+    // a HIR key hit in the stack becomes LIR, the pruning drops key 5
+    cache.get( 2 );
+    cache.get( 6 );
+    CHECK( to_vector( cache ) == std::vector<int>{60, 41, 20, 10, 30} );
+    CHECK( cache.ghost_size() == 0 );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 2 ) );
+        CHECK_FALSE( cache.erase( 2 ) );
+        CHECK( cache.erase( 3 ) );
+        CHECK( cache.lir_size() == 2 );
+
+        // the freed LIR slot is taken by the next new key
+        cache.put( 7, 70 );
+        CHECK( to_vector( cache ) == std::vector<int>{70, 60, 41, 10} );
+        CHECK( cache.lir_size() == 3 );
+    }
+}
+
+TEST_CASE( "LIRS scan resistance" )
+{
+    lirs_cache<int, int> cache( 10 );
+
+    for( int i = 0; i < 9; i++ )
+    {
+        cache.put( i, i );
+    }
+    for( int i = 100; i < 1100; i++ )
+    {
+        cache.put( i, i );
+    }
+    for( int i = 0; i < 9; i++ )
+    {
+        CHECK( cache.contains( i ) );
+    }
+    CHECK( cache.size() == 10 );
+
+    // the non-resident keys are bounded by the capacity
+    CHECK( cache.ghost_size() <= 10 );
+}
+
+// A loop over a few more keys than the cache holds, on which LRU always
+// evicts the key needed next.
+TEST_CASE( "LIRS cyclic access" )
+{
+    const size_t cache_size = 100;
+    const int    loop_size  = 120;
+    const int    loops      = 50;
+
+    lirs_cache<int, int> lirs( cache_size );
+    lru_cache<int, int>  lru( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    size_t lirs_hits = 0;
+    size_t lru_hits  = 0;
+    for( int loop = 0; loop < loops; loop++ )
+    {
+        for( int key = 0; key < loop_size; key++ )
+        {
+            lirs_hits += access( lirs, key );
+            lru_hits += access( lru, key );
+        }
+    }
+
+    CHECK( lru_hits == 0 );
+    // the LIR keys hit on every loop but the first one
+    CHECK( lirs_hits >= ( loops - 1 ) * ( cache_size - 1 ) );
+    CHECK( lirs.ghost_size() <= cache_size );
+}
+
+TEST_CASE( "LIRS heterogeneous lookup" )
+{
+    lirs_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    cache.put( "three", 33 );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "LIRS ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    lirs_cache<int, TestType> cache( cache_len );
+
+    // fills the stack with non-resident keys
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_vector( cache );
+    REQUIRE( cache.ghost_size() > 0 );
+
+    SECTION( "ctors" )
+    {
+        lirs_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.lir_size() == cache.lir_size() );
+        CHECK( cache_new.ghost_size() == cache.ghost_size() );
+
+        // the stack and the non-resident keys are copied too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+        CHECK( cache_new.ghost_size() == cache.ghost_size() );
+    }
+
+    SECTION( "assignment" )
+    {
+        lirs_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        lirs_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache.ghost_size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "lirs_cache erase_if and clear" )
+{
+    lirs_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 200; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 200; i < 300; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.ghost_size() > 0 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.ghost_size() == 0 );
+    CHECK( cache.lir_size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
+
+// Erasing the LIR keys leaves the LIR set empty, the keys used next refill
+// it and the stack bottom is a LIR key again.
+TEST_CASE( "LIRS erase of the LIR set" )
+{
+    lirs_cache<int, int> cache( 3 );
+
+    for( int i = 1; i <= 3; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    cache.erase( 1 );
+    cache.erase( 2 );
+    CHECK( cache.lir_size() == 0 );
+
+    REQUIRE( cache.get( 3 ) != cache.end() );
+    for( int i = 4; i <= 6; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    REQUIRE( cache.get( 6 ) != cache.end() );
+    CHECK( cache.size() == 3 );
+    CHECK( cache.lir_size() == 2 );
+
+    for( int i = 7; i <= 20; i++ )
+    {
+        cache.put( i, i * 10 );
+        cache.get( i - 1 );
+        cache.get( i - 3 );
+    }
+    CHECK( cache.size() == 3 );
+    CHECK( cache.lir_size() == 2 );
+    CHECK( cache.ghost_size() <= cache.capacity() );
+}
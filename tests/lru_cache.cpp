@@ -2,16 +2,21 @@
 
 #include <iostream>
 #include <set>
+#include <string_view>
 
 #include <cachew/lru_cache.hpp>
+#include <cachew/sieve_cache.hpp>
 
 #include "common.hpp"
 
 using namespace cachew;
 
-TEST_CASE( "LRU iterator" )
+// The tests of the interface without hits run against sieve_cache too, both
+// caches evict the oldest entry if none was hit.
+TEMPLATE_PRODUCT_TEST_CASE( "LRU iterator", "", ( lru_cache, sieve_cache ),
+                            ( ( int, int ) ) )
 {
-    lru_cache<int, int> cache( 5 );
+    TestType cache( 5 );
 
     cache.put( 1, 11 );
     cache.put( 2, 22 );
@@ -29,9 +34,10 @@ TEST_CASE( "LRU iterator" )
     CHECK( to_set( cache ) == expected );
 }
 
-TEST_CASE( "LRU cache size" )
+TEMPLATE_PRODUCT_TEST_CASE( "LRU cache size", "", ( lru_cache, sieve_cache ),
+                            ( ( int, int ) ) )
 {
-    lru_cache<int, int> cache( 5 );
+    TestType cache( 5 );
 
     CHECK( cache.size() == 0 );
     CHECK( cache.capacity() == 5 );
@@ -52,20 +58,28 @@ TEST_CASE( "LRU cache size" )
     CHECK( to_set( cache ) == std::set<int>{11, 60, 77, 80, 90} );
 }
 
-TEMPLATE_TEST_CASE( "LRU ctors and assignment", "", int, float,
-                    std::string ) // NOLINT
+// `lru_cache` keeping its entries in a slab.
+template <class _Key, class _Tp>
+using slab_lru_cache = lru_cache<_Key, _Tp, slab_storage>;
+
+TEMPLATE_PRODUCT_TEST_CASE( "LRU ctors and assignment", "",
+                            ( lru_cache, slab_lru_cache, sieve_cache ),
+                            ( ( int, int ), ( int, float ),
+                              ( int, std::string ) ) ) // NOLINT
 {
+    using value_type = typename TestType::value_type;
+
     const size_t data_len  = 1000;
     const size_t cache_len = data_len / 2;
 
-    std::vector<TestType> buff;
+    std::vector<value_type> buff;
     gen_test_seq( data_len, buff );
 
-    lru_cache<int, TestType> cache( cache_len );
+    TestType cache( cache_len );
 
     auto m = buff.begin();
     std::advance( m, cache_len );
-    std::set<TestType> expected( m, buff.end() );
+    std::set<value_type> expected( m, buff.end() );
 
     for( size_t i = 0; i < buff.size(); i++ )
     {
@@ -74,14 +88,34 @@ TEMPLATE_TEST_CASE( "LRU ctors and assignment", "", int, float,
 
     SECTION( "ctors" )
     {
-        lru_cache<int, TestType> cache_new( cache ); // NOLINT
+        TestType cache_new( cache ); // NOLINT
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "move" )
+    {
+        TestType cache_new( std::move( cache ) );
 
         CHECK( to_set( cache_new ) == expected );
+
+        // the source is left empty, a slab one without capacity
+        CHECK( cache.size() == 0 );
+        cache.clear();
+        cache.put( -1, buff[0] );
+        CHECK( cache.size() == std::min<size_t>( cache.capacity(), 1 ) );
+
+        cache = std::move( cache_new );
+        CHECK( to_set( cache ) == expected );
+        CHECK( cache_new.size() == 0 );
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() ==
+               std::min<size_t>( cache_new.capacity(), 1 ) );
     }
 
     SECTION( "assignment" )
     {
-        lru_cache<int, TestType> cache_new( cache_len );
+        TestType cache_new( cache_len );
 
         cache_new = cache;
 
@@ -90,7 +124,7 @@ TEMPLATE_TEST_CASE( "LRU ctors and assignment", "", int, float,
 
     SECTION( "swap" )
     {
-        lru_cache<int, TestType> cache_new( cache_len );
+        TestType cache_new( cache_len );
 
         std::swap( cache_new, cache );
 
@@ -99,3 +133,518 @@ TEMPLATE_TEST_CASE( "LRU ctors and assignment", "", int, float,
         CHECK( to_set( cache_new ) == expected );
     }
 }
+
+TEST_CASE( "LRU slab storage" )
+{
+    lru_cache<int, int, slab_storage> cache( 5 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    REQUIRE( cache.size() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+
+    cache.put( 7, 77 );
+    cache.put( 1, 11 );
+
+    CHECK( cache.size() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{11, 60, 77, 80, 90} );
+
+    SECTION( "get" )
+    {
+        auto it = cache.get( 6 );
+        REQUIRE( it != cache.end() );
+        CHECK( *it == 60 );
+
+        cache.put( 2, 22 );
+        CHECK( cache.get( 8 ) == cache.end() );
+        CHECK( to_set( cache ) == std::set<int>{11, 22, 60, 77, 90} );
+    }
+
+    SECTION( "copy" )
+    {
+        lru_cache<int, int, slab_storage> cache_new( cache ); // NOLINT
+
+        cache_new.put( 6, 66 );
+        cache_new.put( 2, 22 );
+
+        CHECK( to_set( cache_new ) == std::set<int>{11, 22, 66, 77, 90} );
+        CHECK( to_set( cache ) == std::set<int>{11, 60, 77, 80, 90} );
+    }
+}
+
+TEST_CASE( "LRU slab storage with non-trivial values" )
+{
+    std::vector<std::string> buff;
+    gen_test_seq( 100, buff );
+
+    lru_cache<std::string, std::string, slab_storage> cache( 10 );
+    for( const auto &val : buff )
+    {
+        cache.put( val, val );
+    }
+
+    CHECK( cache.size() == 10 );
+    CHECK( to_set( cache ) ==
+           std::set<std::string>( buff.end() - 10, buff.end() ) );
+}
+
+TEST_CASE( "LRU swiss index" )
+{
+    lru_cache<int, int, list_storage, swiss_index> cache( 5 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    REQUIRE( cache.size() == 5 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+
+    CHECK( cache.get( 1 ) == cache.end() );
+    REQUIRE( cache.get( 5 ) != cache.end() );
+
+    cache.put( 1, 11 );
+    CHECK( to_set( cache ) == std::set<int>{11, 50, 70, 80, 90} );
+
+    lru_cache<int, int, slab_storage, swiss_index> slab_cache( 5 );
+    for( int i = 0; i < 10; i++ )
+    {
+        slab_cache.put( i, i * 10 );
+    }
+    CHECK( to_set( slab_cache ) == std::set<int>{50, 60, 70, 80, 90} );
+}
+
+TEST_CASE( "LRU heterogeneous lookup" )
+{
+    lru_cache<std::string, int> cache( 3 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+    cache.put( "three", 3 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.get( std::string_view( "four" ) ) == cache.end() );
+
+    CHECK( cache.contains( key ) );
+    CHECK( cache.contains( "two" ) );
+    CHECK_FALSE( cache.contains( "four" ) );
+
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK_FALSE( cache.erase( "two" ) );
+    CHECK( cache.size() == 2 );
+    CHECK( to_set( cache ) == std::set<int>{1, 3} );
+
+    lru_cache<std::string, int, slab_storage, swiss_index> slab_cache( 2 );
+    slab_cache.put( "one", 1 );
+    slab_cache.put( "two", 2 );
+    CHECK( slab_cache.erase( key ) );
+    slab_cache.put( "three", 3 );
+    CHECK( slab_cache.contains( std::string_view( "two" ) ) );
+    CHECK( to_set( slab_cache ) == std::set<int>{2, 3} );
+}
+
+TEMPLATE_TEST_CASE( "LRU batch operations", "", std_index,
+                    swiss_index ) // NOLINT
+{
+    const int cache_size = 50;
+
+    lru_cache<int, int, list_storage, TestType> cache( cache_size );
+    lru_cache<int, int, list_storage, TestType> expected( cache_size );
+
+    std::vector<std::pair<int, int>> items;
+    for( int i = 0; i < 100; i++ )
+    {
+        items.emplace_back( i % 70, i );
+    }
+    cache.put_many( items.begin(), items.end() );
+    for( const auto &item : items )
+    {
+        expected.put( item.first, item.second );
+    }
+
+    REQUIRE( cache.size() == expected.size() );
+    CHECK( to_set( cache ) == to_set( expected ) );
+
+    std::vector<int> keys;
+    for( int i = 0; i < 80; i++ )
+    {
+        keys.push_back( ( i * 13 ) % 90 );
+    }
+
+    using iterator = typename decltype( cache )::iterator;
+    std::vector<iterator> found;
+    cache.get_many( keys.begin(), keys.end(), std::back_inserter( found ) );
+
+    REQUIRE( found.size() == keys.size() );
+    for( size_t i = 0; i < keys.size(); i++ )
+    {
+        auto it = expected.get( keys[i] );
+        if( it == expected.end() )
+        {
+            CHECK( found[i] == cache.end() );
+        }
+        else
+        {
+            REQUIRE( found[i] != cache.end() );
+            CHECK( *found[i] == *it );
+        }
+    }
+
+    // the recency order must match a loop of `get`
+    CHECK( to_vector( cache ) == to_vector( expected ) );
+}
+
+TEST_CASE( "LRU weighted capacity" )
+{
+    using weighted_cache =
+        lru_cache<int, std::string, list_storage, std_index, default_hash<int>,
+                  default_key_equal<int>, string_size_weigher>;
+
+    weighted_cache cache( 100, 10 );
+    CHECK( cache.max_weight() == 10 );
+
+    cache.put( 1, std::string( "aaaa" ) );
+    cache.put( 2, std::string( "bbbb" ) );
+    CHECK( cache.weight() == 8 );
+
+    // evicts the least recently used entries until the new one fits
+    cache.get( 1 );
+    cache.put( 3, std::string( "ccc" ) );
+    CHECK( cache.weight() == 7 );
+    CHECK( cache.contains( 1 ) );
+    CHECK_FALSE( cache.contains( 2 ) );
+
+    // an update which grows the entry evicts the others
+    cache.put( 3, std::string( "cccccccc" ) );
+    CHECK( cache.weight() == 8 );
+    CHECK( cache.size() == 1 );
+
+    // too heavy entries are not cached and replace nothing
+    cache.put( 4, std::string( 11, 'd' ) );
+    CHECK_FALSE( cache.contains( 4 ) );
+    CHECK( cache.contains( 3 ) );
+    cache.put( 3, std::string( 11, 'c' ) );
+    CHECK_FALSE( cache.contains( 3 ) );
+    CHECK( cache.weight() == 0 );
+
+    cache.put( 5, std::string( "ee" ) );
+    cache.erase( 5 );
+    CHECK( cache.weight() == 0 );
+
+    weighted_cache copy( 100, 10 );
+    cache.put( 6, std::string( "ff" ) );
+    copy = cache;
+    CHECK( copy.weight() == 2 );
+}
+
+TEST_CASE( "LRU unit weigher" )
+{
+    lru_cache<int, int> cache( 3 );
+    CHECK( cache.max_weight() == UNLIMITED_WEIGHT );
+
+    for( int i = 0; i < 5; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.weight() == cache.size() );
+}
+
+TEMPLATE_TEST_CASE( "LRU TTL", "", list_storage, slab_storage )
+{
+    using ttl_cache =
+        lru_cache<int, int, TestType, std_index, default_hash<int>,
+                  default_key_equal<int>, unit_weigher, manual_clock>;
+    using std::chrono::milliseconds;
+
+    ttl_cache cache( 10 );
+
+    cache.put( 1, 11, milliseconds( 100 ) );
+    cache.put( 2, 22, milliseconds( 200 ) );
+    cache.put( 3, 33 );
+    CHECK( cache.get( 1 ) != cache.end() );
+
+    manual_clock::advance( milliseconds( 100 ) );
+
+    // expired entries are not returned, even before their timer fires
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.get( 1 ) == cache.end() );
+    CHECK( cache.size() == 2 );
+
+    // a put without TTL clears it
+    cache.put( 2, 222 );
+    manual_clock::advance( milliseconds( 1000 ) );
+    CHECK( *cache.get( 2 ) == 222 );
+
+    // expired entries are removed before any live one is evicted
+    for( int i = 0; i < 5; ++i )
+    {
+        cache.put( 10 + i, i, milliseconds( 50 ) );
+    }
+    ttl_cache copy( cache );
+    CHECK( cache.size() == 7 );
+    manual_clock::advance( milliseconds( 50 ) );
+    cache.expire();
+    CHECK( cache.size() == 2 );
+    CHECK( cache.contains( 2 ) );
+    CHECK( cache.contains( 3 ) );
+
+    // copies keep the timers
+    CHECK_FALSE( copy.contains( 10 ) );
+    copy.put( 4, 44 );
+    CHECK( copy.size() == 3 );
+
+    // a put with a new TTL reschedules the entry
+    cache.put( 5, 55, milliseconds( 10 ) );
+    cache.put( 5, 56, std::chrono::hours( 1 ) );
+    manual_clock::advance( milliseconds( 10 ) );
+    cache.expire();
+    CHECK( cache.contains( 5 ) );
+    manual_clock::advance( std::chrono::hours( 1 ) );
+    cache.expire();
+    CHECK_FALSE( cache.contains( 5 ) );
+
+    CHECK( cache.erase( 3 ) );
+    cache.put( 6, 66, std::chrono::hours( 24 * 30 ) );
+    manual_clock::advance( std::chrono::hours( 24 * 30 ) );
+    cache.expire();
+    CHECK( cache.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "LRU try_emplace and get_or_compute", "", std_index,
+                    swiss_index )
+{
+    lru_cache<int, std::string, list_storage, TestType> cache( 3 );
+
+    auto [it, inserted] = cache.try_emplace( 1, 3, 'a' );
+    CHECK( inserted );
+    CHECK( *it == "aaa" );
+
+    std::tie( it, inserted ) = cache.try_emplace( 1, 3, 'b' );
+    CHECK_FALSE( inserted );
+    CHECK( *it == "aaa" );
+
+    int calls = 0;
+    auto compute = [&calls]( int key ) {
+        ++calls;
+        return std::to_string( key );
+    };
+    CHECK( *cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( *cache.get_or_compute( 2, compute ) == "2" );
+    CHECK( calls == 1 );
+
+    // a hit is the most recently used entry
+    cache.put( 3, std::string( "3" ) );
+    cache.try_emplace( 1 );
+    cache.get_or_compute( 4, compute );
+    CHECK( cache.size() == 3 );
+    CHECK_FALSE( cache.contains( 2 ) );
+    CHECK( cache.contains( 1 ) );
+
+    // a throwing computation leaves no entry behind
+    CHECK_THROWS( cache.get_or_compute(
+        5, []( int ) -> std::string { throw std::runtime_error( "" ); } ) );
+    CHECK_FALSE( cache.contains( 5 ) );
+    CHECK( cache.size() == 3 );
+    CHECK( to_vector( cache ) ==
+           std::vector<std::string>{ "4", "aaa", "3" } );
+}
+
+TEMPLATE_TEST_CASE( "LRU erase_if and clear", "", list_storage, slab_storage )
+{
+    lru_cache<int, int, TestType> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+    CHECK( cache.erase_if( []( int, int value ) { return value > 500; } ) ==
+           25 );
+    CHECK( cache.size() == 25 );
+
+    // freed entries are reused
+    for( int i = 100; i < 175; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 1 ) );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+    CHECK_FALSE( cache.contains( 1 ) );
+
+    cache.put( 1, 1 );
+    CHECK( *cache.get( 1 ) == 1 );
+}
+
+TEMPLATE_TEST_CASE( "LRU resize", "", list_storage, slab_storage )
+{
+    using resized_cache =
+        lru_cache<int, int, TestType, std_index, default_hash<int>,
+                  default_key_equal<int>, unit_weigher, manual_clock>;
+
+    resized_cache cache( 1000 );
+    for( int i = 0; i < 1000; ++i )
+    {
+        cache.put( i, i );
+    }
+
+    // the eviction is spread over the following operations
+    cache.resize( 100 );
+    CHECK( cache.capacity() == 100 );
+    CHECK( cache.size() == 1000 );
+    cache.put( 1000, 1000 );
+    CHECK( cache.size() < 1000 );
+    CHECK( cache.size() > 100 );
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.get( 999 );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 1000 ) );
+    CHECK_FALSE( cache.contains( 800 ) );
+
+    // a bigger slab is allocated when the cache grows beyond it
+    cache.put( 5000, 5000, std::chrono::milliseconds( 10 ) );
+    cache.resize( 2000 );
+    for( int i = 2000; i < 3900; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 2000 );
+    CHECK( *cache.get( 1000 ) == 1000 );
+    CHECK( *cache.get( 3899 ) == 3899 );
+
+    manual_clock::advance( std::chrono::milliseconds( 10 ) );
+    cache.expire();
+    CHECK_FALSE( cache.contains( 5000 ) );
+    CHECK( cache.size() == 1999 );
+}
+
+TEMPLATE_TEST_CASE( "LRU promotion", "", list_storage, slab_storage )
+{
+    lru_cache<int, int, TestType> cache( 3 );
+
+    CHECK( cache.promotion().probability() == 1.0 );
+    CHECK( cache.promotion().min_age() == 0 );
+
+    for( int i = 1; i <= 3; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    SECTION( "min_age" )
+    {
+        cache.set_promotion( promotion_policy( 1.0, 2 ) );
+
+        // 3 is in front, 1 is two moves behind it
+        cache.get( 3 );
+        cache.get( 1 );
+        cache.put( 4, 40 );
+        CHECK( to_set( cache ) == std::set<int>{10, 30, 40} );
+
+        // 2 moves since 3 was added
+        cache.get( 3 );
+        cache.put( 5, 50 );
+        CHECK( to_set( cache ) == std::set<int>{30, 40, 50} );
+    }
+
+    SECTION( "probability" )
+    {
+        cache.set_promotion( promotion_policy( 0.0 ) );
+
+        REQUIRE( cache.get( 1 ) != cache.end() );
+        cache.put( 4, 40 );
+        CHECK( to_set( cache ) == std::set<int>{20, 30, 40} );
+
+        // an update always moves the entry
+        cache.put( 2, 22 );
+        cache.put( 5, 50 );
+        CHECK( to_set( cache ) == std::set<int>{22, 40, 50} );
+
+        using iterator = typename decltype( cache )::iterator;
+        std::vector<int>      keys{2, 4};
+        std::vector<iterator> found;
+        cache.get_many( keys.begin(), keys.end(), std::back_inserter( found ) );
+        CHECK( found.size() == 2 );
+        cache.put( 6, 60 );
+        CHECK( to_set( cache ) == std::set<int>{22, 50, 60} );
+    }
+}
+
+TEST_CASE( "Promotion policy" )
+{
+    promotion_policy always;
+    CHECK( always.promotes( 0 ) );
+
+    promotion_policy never( 0.0 );
+    CHECK_FALSE( never.promotes( 100 ) );
+
+    promotion_policy old( 1.0, 10 );
+    CHECK_FALSE( old.promotes( 9 ) );
+    CHECK( old.promotes( 10 ) );
+
+    promotion_policy quarter( 0.25 );
+    CHECK( quarter.probability() == Approx( 0.25 ) );
+
+    size_t promoted = 0;
+    for( int i = 0; i < 100'000; i++ )
+    {
+        promoted += quarter.promotes( 0 ) ? 1 : 0;
+    }
+    CHECK( promoted > 24'000 );
+    CHECK( promoted < 26'000 );
+}
+
+TEMPLATE_TEST_CASE( "LRU capacity 0", "", list_storage, slab_storage )
+{
+    lru_cache<int, int, TestType> cache( 0 );
+
+    cache.put( 1, 1 );
+    cache.put( 2, 2 );
+    CHECK( cache.size() == 0 );
+    CHECK_FALSE( cache.contains( 2 ) );
+
+    CHECK( cache.try_emplace( 3, 3 ) ==
+           std::make_pair( cache.end(), false ) );
+    CHECK( cache.get_or_compute( 4, []( int key ) { return key; } ) ==
+           cache.end() );
+
+    std::vector<std::pair<int, int>> items{{5, 5}, {6, 6}};
+    cache.put_many( items.begin(), items.end() );
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    SECTION( "resize" )
+    {
+        lru_cache<int, int, TestType> resized( 10 );
+        for( int i = 0; i < 5; i++ )
+        {
+            resized.put( i, i );
+        }
+
+        resized.resize( 0 );
+        resized.put( 5, 5 );
+        CHECK( resized.size() == 0 );
+        resized.put( 6, 6 );
+        CHECK_FALSE( resized.contains( 6 ) );
+        CHECK( resized.weight() == 0 );
+
+        resized.resize( 2 );
+        resized.put( 7, 7 );
+        CHECK( to_set( resized ) == std::set<int>{7} );
+    }
+}
@@ -1,14 +1,45 @@
 #include "catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <map>
+#include <random>
 #include <set>
+#include <thread>
 
+#include <cachew/clock_cache.hpp>
+#include <cachew/concurrent_cache.hpp>
+#include <cachew/flat_lfu_cache.hpp>
+#include <cachew/lfu_cache.hpp>
+#include <cachew/lirs_cache.hpp>
 #include <cachew/lru_cache.hpp>
+#include <cachew/s3fifo_cache.hpp>
+#include <cachew/sieve_cache.hpp>
 
 #include "common.hpp"
 
 using namespace cachew;
 
+using int_lru_cache    = lru_cache<int, int>;
+using int_clock_cache  = clock_cache<int, int>;
+using int_lirs_cache   = lirs_cache<int, int>;
+using int_s3fifo_cache = s3fifo_cache<int, int>;
+using int_sieve_cache  = sieve_cache<int, int>;
+using ttl_lru_cache =
+    lru_cache<int, int, list_storage, std_index, default_hash<int>,
+              default_key_equal<int>, unit_weigher, manual_clock>;
+using ttl_lfu_cache = lfu_cache<int, int, std_index, default_hash<int>,
+                                default_key_equal<int>, unit_weigher,
+                                manual_clock>;
+using int_lfu_cache        = lfu_cache<int, int>;
+using swiss_lfu_cache      = lfu_cache<int, int, swiss_index>;
+using swiss_flat_lfu_cache = flat_lfu_cache<int, int, swiss_index>;
+using aging_lfu_cache =
+    lfu_cache<int, int, std_index, default_hash<int>, default_key_equal<int>,
+              unit_weigher, std::chrono::steady_clock, dynamic_aging>;
+
 TEST_CASE( "LRU cache benchmark", "[benchmark]" )
 {
     SECTION( "POD types, 500 elements" )
@@ -77,4 +108,663 @@ TEST_CASE( "LRU cache benchmark", "[benchmark]" )
             }
         };
     }
+    SECTION( "POD types, 50'000 elements, slab storage" )
+    {
+        const size_t                      cache_size      = 50'000;
+        const size_t                      iteration_count = 100'000;
+        lru_cache<int, int, slab_storage> cache( cache_size );
+
+        BENCHMARK( "integer slab cache put (50'000, 100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.put( i, i );
+            }
+        };
+
+        BENCHMARK( "integer slab cache get (100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.get( i );
+            }
+        };
+    }
+}
+
+// Random keys looked up in random order, so the benchmark is not dominated by
+// the locality of `std::hash` on sequential integers.
+TEMPLATE_TEST_CASE( "Cache index benchmark", "[benchmark]", std_index,
+                    swiss_index )
+{
+    const size_t cache_size      = 50'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937                       gen( 42 );
+    std::uniform_int_distribution<int> dis;
+
+    std::vector<int> keys( cache_size );
+    std::vector<int> missed( cache_size );
+    for( size_t i = 0; i < cache_size; i++ )
+    {
+        keys[i]   = dis( gen );
+        missed[i] = dis( gen );
+    }
+    std::vector<int> lookups( keys );
+    std::shuffle( lookups.begin(), lookups.end(), gen );
+
+    SECTION( "LRU, 50'000 elements" )
+    {
+        lru_cache<int, int, list_storage, TestType> cache( cache_size );
+        for( int key : keys )
+        {
+            cache.put( key, key );
+        }
+
+        BENCHMARK( "integer cache get, hits (100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.get( lookups[i % cache_size] );
+            }
+        };
+
+        BENCHMARK( "integer cache get, misses (100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.get( missed[i % cache_size] );
+            }
+        };
+    }
+    SECTION( "LFU, 50'000 elements" )
+    {
+        lfu_cache<int, int, TestType> cache( cache_size );
+        for( int key : keys )
+        {
+            cache.put( key, key );
+        }
+
+        BENCHMARK( "integer cache get, hits (100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.get( lookups[i % cache_size] );
+            }
+        };
+
+        BENCHMARK( "integer cache get, misses (100'000 iterations)" )
+        {
+            for( size_t i = 0; i < iteration_count; i++ )
+            {
+                cache.get( missed[i % cache_size] );
+            }
+        };
+    }
+}
+
+TEMPLATE_TEST_CASE( "LRU batch benchmark", "[benchmark]", std_index,
+                    swiss_index )
+{
+    const size_t cache_size      = 1'000'000;
+    const size_t iteration_count = 100'000;
+    const size_t batch_size      = 64;
+
+    std::mt19937                       gen( 42 );
+    std::uniform_int_distribution<int> dis;
+
+    std::vector<int> keys( cache_size );
+    for( auto &key : keys )
+    {
+        key = dis( gen );
+    }
+
+    lru_cache<int, int, list_storage, TestType> cache( cache_size );
+    for( int key : keys )
+    {
+        cache.put( key, key );
+    }
+
+    std::vector<int> lookups( iteration_count );
+    for( auto &key : lookups )
+    {
+        key = keys[dis( gen ) % cache_size];
+    }
+
+    using iterator = typename decltype( cache )::iterator;
+    std::vector<iterator> found( batch_size );
+
+    BENCHMARK( "integer cache get (1'000'000, 100'000 iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            found[i % batch_size] = cache.get( lookups[i] );
+        }
+    };
+
+    BENCHMARK( "integer cache get_many, batches of 64 (1'000'000, 100'000 "
+               "iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i += batch_size )
+        {
+            auto first = lookups.begin() + i;
+            cache.get_many( first,
+                            first + std::min( batch_size, iteration_count - i ),
+                            found.begin() );
+        }
+    };
+}
+
+// A hit in lru_cache relinks the entry, a hit in clock_cache and in
+// sieve_cache only sets a flag and one in s3fifo_cache increments a counter.
+TEMPLATE_TEST_CASE( "Cache hit path benchmark", "[benchmark]", int_lru_cache,
+                    int_clock_cache, int_s3fifo_cache, int_sieve_cache )
+{
+    const size_t cache_size      = 50'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937                       gen( 42 );
+    std::uniform_int_distribution<int> dis;
+
+    std::vector<int> keys( cache_size );
+    for( auto &key : keys )
+    {
+        key = dis( gen );
+    }
+
+    TestType cache( cache_size );
+    for( int key : keys )
+    {
+        cache.put( key, key );
+    }
+
+    std::vector<int> lookups( iteration_count );
+    for( auto &key : lookups )
+    {
+        key = keys[dis( gen ) % cache_size];
+    }
+
+    BENCHMARK( "integer cache get, hits (50'000, 100'000 iterations)" )
+    {
+        for( int key : lookups )
+        {
+            cache.get( key );
+        }
+    };
+
+    BENCHMARK( "integer cache put, mostly new keys (50'000, 100'000 "
+               "iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            cache.put( lookups[i] + 1, i );
+        }
+    };
+}
+
+// The clock moves a tick every 1'000 puts and every entry lives 1'000 ticks,
+// so puts with TTL expire as many entries as they add and never evict, while
+// plain puts evict an entry each.
+TEMPLATE_TEST_CASE( "TTL expiry benchmark", "[benchmark]", ttl_lru_cache,
+                    ttl_lfu_cache )
+{
+    const size_t cache_size      = 1'000'000;
+    const size_t iteration_count = 100'000;
+    const size_t puts_per_tick   = 1'000;
+
+    const std::chrono::milliseconds ttl( cache_size / puts_per_tick );
+
+    TestType cache( cache_size );
+    int      key = 0;
+    for( size_t i = 0; i < cache_size; i++ )
+    {
+        if( i % puts_per_tick == 0 )
+        {
+            manual_clock::advance( std::chrono::milliseconds( 1 ) );
+        }
+        cache.put( key++, 0, ttl );
+    }
+
+    BENCHMARK( "integer cache put with TTL, expiring (1'000'000, 100'000 "
+               "iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            if( i % puts_per_tick == 0 )
+            {
+                manual_clock::advance( std::chrono::milliseconds( 1 ) );
+            }
+            cache.put( key++, 0, ttl );
+        }
+    };
+
+    BENCHMARK( "integer cache put, evicting (1'000'000, 100'000 iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            cache.put( key++, 0 );
+        }
+    };
+}
+
+// A miss handled by `get` and `put` looks the key up twice, `get_or_compute`
+// once.
+TEMPLATE_TEST_CASE( "LRU get_or_compute benchmark", "[benchmark]", std_index,
+                    swiss_index )
+{
+    const size_t cache_size      = 50'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937                       gen( 42 );
+    std::uniform_int_distribution<int> dis( 0, 4 * cache_size );
+
+    std::vector<int> lookups( iteration_count );
+    for( auto &key : lookups )
+    {
+        key = dis( gen );
+    }
+
+    lru_cache<int, int, list_storage, TestType> cache( cache_size );
+    auto compute = []( int key ) { return key * 2; };
+
+    BENCHMARK( "integer cache get, put on a miss (50'000, 100'000 "
+               "iterations)" )
+    {
+        for( int key : lookups )
+        {
+            if( cache.get( key ) == cache.end() )
+            {
+                cache.put( key, compute( key ) );
+            }
+        }
+    };
+
+    BENCHMARK( "integer cache get_or_compute (50'000, 100'000 iterations)" )
+    {
+        for( int key : lookups )
+        {
+            cache.get_or_compute( key, compute );
+        }
+    };
+}
+
+// A loop over 20% more keys than the cache holds, every miss is loaded from
+// a large ordered map. lru_cache always evicts the key needed next and
+// misses every lookup, lirs_cache keeps its LIR keys and misses about one
+// lookup in 5.
+TEMPLATE_TEST_CASE( "Cyclic access benchmark", "[benchmark]", int_lru_cache,
+                    int_lirs_cache )
+{
+    const size_t cache_size      = 50'000;
+    const int    loop_size       = 60'000;
+    const size_t iteration_count = 100'000;
+    const int    store_size      = 1'000'000;
+
+    std::map<int, int> store;
+    for( int key = 0; key < store_size; key++ )
+    {
+        store.emplace( key, key );
+    }
+
+    // keys spread over the store
+    auto load = [&store, step = store_size / loop_size]( int key ) {
+        return store.find( key * step )->second;
+    };
+
+    TestType cache( cache_size );
+    for( int key = 0; key < loop_size; key++ )
+    {
+        cache.put( key, load( key ) );
+    }
+
+    int key = 0;
+    BENCHMARK( "integer cache get, load on a miss (50'000, loop of 60'000, "
+               "100'000 iterations)" )
+    {
+        size_t hits = 0;
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            if( cache.get( key ) != cache.end() )
+            {
+                ++hits;
+            }
+            else
+            {
+                cache.put( key, load( key ) );
+            }
+            key = ( key + 1 ) % loop_size;
+        }
+        return hits;
+    };
+}
+
+// Zipf keys whose hot set moves to another range after warming up, every
+// miss costs the same fixed work. lfu_cache keeps the old hot keys
+// and misses almost every new one, the aging cache evicts them and gets
+// back to its hit ratio.
+TEMPLATE_TEST_CASE( "Hot set change benchmark", "[benchmark]", int_lfu_cache,
+                    aging_lfu_cache )
+{
+    const size_t cache_size      = 5'000;
+    const int    key_count       = 500'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    // a thousand rounds of xorshift
+    auto load = []( int key ) {
+        auto value = static_cast<unsigned>( key ) | 1u;
+        for( int i = 0; i < 1000; i++ )
+        {
+            value ^= value << 13;
+            value ^= value >> 17;
+            value ^= value << 5;
+        }
+        return static_cast<int>( value );
+    };
+    auto access = [&load]( TestType &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, load( key ) );
+        return size_t( 0 );
+    };
+
+    TestType cache( cache_size );
+    for( size_t i = 0; i < iteration_count * 10; i++ )
+    {
+        access( cache, static_cast<int>( zipf( gen ) ) );
+    }
+
+    std::vector<int> keys( iteration_count );
+    for( auto &key : keys )
+    {
+        key = static_cast<int>( zipf( gen ) ) + key_count;
+    }
+
+    BENCHMARK( "integer cache get, load on a miss (5'000, Zipf over "
+               "500'000 keys moved, 100'000 iterations)" )
+    {
+        size_t hits = 0;
+        for( int key : keys )
+        {
+            hits += access( cache, key );
+        }
+        return hits;
+    };
+}
+
+// lfu_cache keeps its entries in lists of frequency nodes and splices a hit
+// entry from one list to another, flat_lfu_cache links slots and buckets of
+// two arrays by index. Both use the open addressing index, so the flat one
+// does not allocate on a put.
+TEMPLATE_TEST_CASE( "LFU layout benchmark", "[benchmark]", swiss_lfu_cache,
+                    swiss_flat_lfu_cache )
+{
+    const size_t cache_size      = 50'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937                       gen( 42 );
+    std::uniform_int_distribution<int> dis;
+
+    std::vector<int> keys( cache_size );
+    for( auto &key : keys )
+    {
+        key = dis( gen );
+    }
+
+    TestType cache( cache_size );
+    for( int key : keys )
+    {
+        cache.put( key, key );
+    }
+
+    std::vector<int> lookups( iteration_count );
+    for( auto &key : lookups )
+    {
+        key = keys[dis( gen ) % cache_size];
+    }
+
+    BENCHMARK( "integer cache get, hits (50'000, 100'000 iterations)" )
+    {
+        for( int key : lookups )
+        {
+            cache.get( key );
+        }
+    };
+
+    BENCHMARK( "integer cache put, mostly new keys (50'000, 100'000 "
+               "iterations)" )
+    {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            cache.put( lookups[i] + 1, i );
+        }
+    };
+}
+
+// 100M Zipf lookups with a put on every miss. Frequency nodes go with their
+// last entries, so there are never more of them than entries and the
+// eviction latency after the soak is the one of a fresh cache.
+TEST_CASE( "LFU soak benchmark", "[benchmark]" )
+{
+    const size_t cache_size      = 10'000;
+    const size_t iteration_count = 100'000;
+    const size_t round_count     = 10;
+    const size_t round_size      = 10'000'000;
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( 1'000'000, 0.9 );
+
+    std::vector<int> keys( 1 << 20 );
+    for( auto &key : keys )
+    {
+        key = static_cast<int>( zipf( gen ) );
+    }
+
+    swiss_lfu_cache cache( cache_size );
+
+    // every put is of a new key and evicts
+    int  new_key = -1;
+    auto evict   = [&cache, &new_key]() {
+        for( size_t i = 0; i < iteration_count; i++ )
+        {
+            cache.put( new_key--, 0 );
+        }
+    };
+
+    size_t pos = 0;
+    for( size_t round = 0; round < round_count; round++ )
+    {
+        for( size_t i = 0; i < round_size; i++ )
+        {
+            int key = keys[pos++ & ( keys.size() - 1 )];
+            if( cache.get( key ) == cache.end() )
+            {
+                cache.put( key, key );
+            }
+        }
+        CHECK( cache.bucket_count() <= cache.size() );
+        if( round == 0 )
+        {
+            BENCHMARK( "integer cache put, evictions after 10M operations "
+                       "(10'000, 100'000 iterations)" )
+            {
+                evict();
+            };
+        }
+    }
+
+    BENCHMARK( "integer cache put, evictions after 100M operations "
+               "(10'000, 100'000 iterations)" )
+    {
+        evict();
+    };
+}
+
+// Zipf 0.99 keys, where the hot entries are hit over and over. A hit moves
+// its entry always, with a probability of 1/8, or only if the entry is not
+// among the quarter of the cache moved last. Every miss costs a put, the hit
+// ratio of each policy is printed.
+TEMPLATE_TEST_CASE( "Promotion benchmark", "[benchmark]", int_lru_cache,
+                    int_lfu_cache )
+{
+    const size_t cache_size      = 50'000;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( 1'000'000, 0.99 );
+
+    std::vector<int> keys( iteration_count );
+    for( auto &key : keys )
+    {
+        key = static_cast<int>( zipf( gen ) );
+    }
+
+    auto access = []( TestType &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    const std::pair<const char *, promotion_policy> policies[] = {
+        { "integer cache get, every hit promotes (50'000, Zipf 0.99, "
+          "100'000 iterations)",
+          promotion_policy() },
+        { "integer cache get, 1/8 of the hits promote (50'000, Zipf 0.99, "
+          "100'000 iterations)",
+          promotion_policy( 0.125 ) },
+        { "integer cache get, hits behind the first 12'500 entries promote "
+          "(50'000, Zipf 0.99, 100'000 iterations)",
+          promotion_policy( 1.0, cache_size / 4 ) },
+    };
+
+    std::vector<double> hit_ratios;
+    for( const auto &[name, policy] : policies )
+    {
+        TestType cache( cache_size );
+        cache.set_promotion( policy );
+
+        for( size_t i = 0; i < iteration_count * 10; i++ )
+        {
+            access( cache, static_cast<int>( zipf( gen ) ) );
+        }
+        size_t hits = 0;
+        for( int key : keys )
+        {
+            hits += access( cache, key );
+        }
+        hit_ratios.push_back( static_cast<double>( hits ) / keys.size() );
+
+        BENCHMARK( name )
+        {
+            size_t count = 0;
+            for( int key : keys )
+            {
+                count += access( cache, key );
+            }
+            return count;
+        };
+    }
+    for( size_t i = 0; i < hit_ratios.size(); i++ )
+    {
+        std::cout << policies[i].first << ": hit ratio " << hit_ratios[i]
+                  << std::endl;
+    }
+}
+
+// The promotion benchmark on concurrent_cache shared by threads, each of
+// them looks its own Zipf 0.99 keys up. A hit which promotes tries the list
+// lock and skips the move if the lock is taken, so every promotion skipped
+// by the policy is a lock attempt less.
+TEST_CASE( "Concurrent promotion benchmark", "[benchmark]" )
+{
+    using int_concurrent_cache = concurrent_cache<int, int>;
+
+    const size_t cache_size      = 50'000;
+    const size_t threads_count   = 4;
+    const size_t iteration_count = 100'000;
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( 1'000'000, 0.99 );
+
+    std::vector<std::vector<int>> keys( threads_count );
+    for( auto &thread_keys : keys )
+    {
+        thread_keys.resize( iteration_count );
+        for( auto &key : thread_keys )
+        {
+            key = static_cast<int>( zipf( gen ) );
+        }
+    }
+
+    auto access = []( int_concurrent_cache &cache, int key ) {
+        if( cache.get( key ) )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+    auto run = [&keys, &access]( int_concurrent_cache &cache ) {
+        std::atomic<size_t>      hits{ 0 };
+        std::vector<std::thread> threads;
+        for( const auto &thread_keys : keys )
+        {
+            threads.emplace_back( [&cache, &hits, &access, &thread_keys]() {
+                size_t count = 0;
+                for( int key : thread_keys )
+                {
+                    count += access( cache, key );
+                }
+                hits += count;
+            } );
+        }
+        for( auto &thread : threads )
+        {
+            thread.join();
+        }
+        return hits.load();
+    };
+
+    const std::pair<const char *, promotion_policy> policies[] = {
+        { "integer cache get from 4 threads, every hit promotes (50'000, "
+          "Zipf 0.99, 4 x 100'000 iterations)",
+          promotion_policy() },
+        { "integer cache get from 4 threads, 1/8 of the hits promote "
+          "(50'000, Zipf 0.99, 4 x 100'000 iterations)",
+          promotion_policy( 0.125 ) },
+        { "integer cache get from 4 threads, hits behind the first 12'500 "
+          "entries promote (50'000, Zipf 0.99, 4 x 100'000 iterations)",
+          promotion_policy( 1.0, cache_size / 4 ) },
+    };
+
+    std::vector<double> hit_ratios;
+    for( const auto &[name, policy] : policies )
+    {
+        int_concurrent_cache cache( cache_size, UNLIMITED_WEIGHT,
+                                    unit_weigher(), policy );
+
+        for( size_t i = 0; i < iteration_count * 10; i++ )
+        {
+            access( cache, static_cast<int>( zipf( gen ) ) );
+        }
+        hit_ratios.push_back( static_cast<double>( run( cache ) ) /
+                              ( threads_count * iteration_count ) );
+
+        BENCHMARK( name )
+        {
+            return run( cache );
+        };
+    }
+    for( size_t i = 0; i < hit_ratios.size(); i++ )
+    {
+        std::cout << policies[i].first << ": hit ratio " << hit_ratios[i]
+                  << std::endl;
+    }
 }
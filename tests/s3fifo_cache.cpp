@@ -0,0 +1,297 @@
+#include "catch.hpp"
+
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lru_cache.hpp>
+#include <cachew/s3fifo_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "S3-FIFO iterator" )
+{
+    s3fifo_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "S3-FIFO cache size" )
+{
+    s3fifo_cache<int, int> cache( 500 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 500 );
+    CHECK( cache.small_capacity() == 50 );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 500 );
+    CHECK( cache.ghost_size() == 450 );
+
+    s3fifo_cache<int, int> tiny( 1 );
+    tiny.put( 1, 10 );
+    tiny.get( 1 );
+    tiny.put( 2, 20 );
+    CHECK( to_set( tiny ) == std::set<int>{20} );
+
+    s3fifo_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "S3-FIFO queues" )
+{
+    s3fifo_cache<int, int> cache( 10 );
+
+    for( int i = 1; i <= 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( cache.small_size() == 10 );
+    cache.get( 2 );
+
+    // the small FIFO is over its share, its first key leaves a ghost
+    cache.put( 11, 110 );
+    CHECK_FALSE( cache.contains( 1 ) );
+    CHECK( cache.ghost_size() == 1 );
+
+    // a key hit in the small FIFO moves to the main one
+    cache.put( 12, 120 );
+    CHECK( cache.contains( 2 ) );
+    CHECK_FALSE( cache.contains( 3 ) );
+    CHECK( cache.small_size() == 9 );
+
+    // a ghost comes back to the main FIFO
+    cache.put( 1, 11 );
+    CHECK_FALSE( cache.contains( 4 ) );
+    CHECK( cache.small_size() == 8 );
+    CHECK( cache.ghost_size() == 2 );
+
+    // new keys only churn the small FIFO
+    for( int i = 100; i < 200; i++ )
+    {
+        cache.put( i, i );
+    }
+    CHECK( *cache.get( 1 ) == 11 );
+    CHECK( *cache.get( 2 ) == 20 );
+    CHECK( cache.size() == 10 );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 1 ) );
+        CHECK_FALSE( cache.erase( 1 ) );
+        CHECK( cache.erase( 199 ) );
+        CHECK( cache.size() == 8 );
+
+        // a put into a freed slot evicts nothing
+        cache.put( 200, 200 );
+        cache.put( 201, 201 );
+        CHECK( cache.size() == 10 );
+        CHECK( cache.contains( 198 ) );
+        CHECK( cache.contains( 2 ) );
+
+        // the stale queue values of erased keys are skipped
+        for( int i = 0; i < 100; i++ )
+        {
+            cache.put( 300 + i, i );
+            cache.erase( 300 + i );
+        }
+        cache.put( 400, 400 );
+        CHECK( cache.size() == 10 );
+        CHECK( cache.contains( 2 ) );
+    }
+}
+
+// Keys drawn from a Zipf distribution much wider than the cache, the keys
+// seen once do not stay past the small FIFO.
+TEST_CASE( "S3-FIFO hit ratio" )
+{
+    const size_t cache_size = 500;
+    const int    key_count  = 50'000;
+    const size_t lookups    = 200'000;
+
+    s3fifo_cache<int, int> s3fifo( cache_size );
+    lru_cache<int, int>    lru( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    size_t s3fifo_hits = 0;
+    size_t lru_hits    = 0;
+    for( size_t i = 0; i < lookups; i++ )
+    {
+        int key = static_cast<int>( zipf( gen ) );
+        s3fifo_hits += access( s3fifo, key );
+        lru_hits += access( lru, key );
+    }
+
+    CHECK( s3fifo_hits > lru_hits );
+}
+
+TEST_CASE( "S3-FIFO heterogeneous lookup" )
+{
+    s3fifo_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    cache.put( "two", 22 );
+    CHECK( cache.size() == 2 );
+}
+
+TEMPLATE_TEST_CASE( "S3-FIFO ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    s3fifo_cache<int, TestType> cache( cache_len );
+
+    // fills the main FIFO and the ghosts
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+        cache.get( i - i % 7 );
+    }
+    auto expected = to_set( cache );
+    REQUIRE( cache.ghost_size() > 0 );
+
+    SECTION( "ctors" )
+    {
+        s3fifo_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_set( cache_new ) == expected );
+        CHECK( cache_new.small_size() == cache.small_size() );
+        CHECK( cache_new.ghost_size() == cache.ghost_size() );
+
+        // the queues and the counters are copied too
+        for( size_t i = 0; i < buff.size(); i += 3 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_set( cache_new ) == to_set( cache ) );
+    }
+
+    SECTION( "move" )
+    {
+        s3fifo_cache<int, TestType> cache_new( std::move( cache ) );
+
+        CHECK( to_set( cache_new ) == expected );
+
+        // the source is left as an empty cache of capacity 0
+        CHECK( cache.size() == 0 );
+        CHECK( cache.capacity() == 0 );
+        cache.clear();
+        cache.put( -1, buff[0] );
+        CHECK( cache.size() == 0 );
+
+        cache = std::move( cache_new );
+        CHECK( to_set( cache ) == expected );
+        CHECK( cache_new.size() == 0 );
+        cache_new.clear();
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == 0 );
+    }
+
+    SECTION( "assignment" )
+    {
+        s3fifo_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_set( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        s3fifo_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_set( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "s3fifo_cache erase_if and clear" )
+{
+    s3fifo_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK( cache.small_size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.ghost_size() > 0 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.ghost_size() == 0 );
+    CHECK( cache.small_size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lru_cache.hpp>
+#include <cachew/sieve_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+// The iterator, size and ctors tests are shared with lru_cache, see
+// lru_cache.cpp.
+
+TEST_CASE( "SIEVE hand" )
+{
+    sieve_cache<int, int> cache( 4 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    cache.get( 1 );
+    cache.get( 3 );
+
+    // the hand passes the oldest entry, which was visited
+    cache.put( 5, 50 );
+    CHECK( to_vector( cache ) == std::vector<int>{50, 40, 30, 10} );
+
+    // the hand goes on from where it stopped, 3 loses its mark
+    cache.put( 6, 60 );
+    CHECK( to_vector( cache ) == std::vector<int>{60, 50, 30, 10} );
+
+    // the new entries are evicted while the old ones stay
+    cache.put( 7, 70 );
+    cache.put( 8, 80 );
+    CHECK( to_vector( cache ) == std::vector<int>{80, 70, 30, 10} );
+
+    SECTION( "erase" )
+    {
+        // the hand is at 7 and moves to 8
+        CHECK( cache.erase( 7 ) );
+        CHECK_FALSE( cache.erase( 7 ) );
+        cache.put( 9, 90 );
+        CHECK( cache.size() == 4 );
+
+        cache.put( 11, 110 );
+        CHECK( to_vector( cache ) == std::vector<int>{110, 90, 30, 10} );
+    }
+
+    SECTION( "wrap around" )
+    {
+        // the hand passes the newest entry and starts over from the oldest,
+        // which lost its mark on the first pass
+        cache.get( 7 );
+        cache.get( 8 );
+        cache.put( 9, 90 );
+        CHECK( to_vector( cache ) == std::vector<int>{90, 80, 70, 30} );
+        cache.put( 11, 110 );
+        CHECK( to_vector( cache ) == std::vector<int>{110, 90, 80, 70} );
+    }
+}
+
+// Keys drawn from a Zipf distribution much wider than the cache.
+TEST_CASE( "SIEVE hit ratio" )
+{
+    const size_t cache_size = 500;
+    const int    key_count  = 50'000;
+    const size_t lookups    = 200'000;
+
+    sieve_cache<int, int> sieve( cache_size );
+    lru_cache<int, int>   lru( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    size_t sieve_hits = 0;
+    size_t lru_hits   = 0;
+    for( size_t i = 0; i < lookups; i++ )
+    {
+        int key = static_cast<int>( zipf( gen ) );
+        sieve_hits += access( sieve, key );
+        lru_hits += access( lru, key );
+    }
+
+    CHECK( sieve_hits > lru_hits );
+}
+
+TEST_CASE( "SIEVE heterogeneous lookup" )
+{
+    sieve_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+
+    cache.put( "three", 3 );
+    cache.put( "four", 4 );
+    CHECK( cache.contains( "one" ) );
+    CHECK( cache.size() == 2 );
+}
+
+TEST_CASE( "sieve_cache erase_if and clear" )
+{
+    sieve_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+    CHECK( cache.contains( 11 ) );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
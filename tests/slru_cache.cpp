@@ -0,0 +1,304 @@
+#include "catch.hpp"
+
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lru_cache.hpp>
+#include <cachew/slru_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "SLRU iterator" )
+{
+    slru_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "SLRU cache size" )
+{
+    slru_cache<int, int> cache( 5 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 5 );
+    CHECK( cache.protected_capacity() == 4 );
+
+    for( int i = 0; i < 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.size() == 5 );
+    CHECK( cache.protected_size() == 0 );
+    CHECK( to_set( cache ) == std::set<int>{50, 60, 70, 80, 90} );
+
+    slru_cache<int, int> clamped( 2, 10 );
+    CHECK( clamped.protected_capacity() == 2 );
+}
+
+TEST_CASE( "SLRU promotion and demotion" )
+{
+    slru_cache<int, int> cache( 4, 2 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( to_vector( cache ) == std::vector<int>{40, 30, 20, 10} );
+
+    // hits move entries to the protected segment
+    cache.get( 1 );
+    cache.get( 2 );
+    CHECK( cache.protected_size() == 2 );
+    CHECK( to_vector( cache ) == std::vector<int>{20, 10, 40, 30} );
+
+    // the protected overflow goes back to the head of probation
+    cache.get( 3 );
+    CHECK( cache.protected_size() == 2 );
+    CHECK( to_vector( cache ) == std::vector<int>{30, 20, 10, 40} );
+
+    // new entries evict the tail of probation
+    cache.put( 5, 50 );
+    CHECK( to_vector( cache ) == std::vector<int>{30, 20, 50, 10} );
+    cache.put( 6, 60 );
+    CHECK( to_vector( cache ) == std::vector<int>{30, 20, 60, 50} );
+
+    // an update is a hit
+    cache.put( 5, 55 );
+    CHECK( to_vector( cache ) == std::vector<int>{55, 30, 20, 60} );
+    cache.put( 7, 70 );
+    CHECK( to_vector( cache ) == std::vector<int>{55, 30, 70, 20} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 5 ) );
+        CHECK_FALSE( cache.erase( 5 ) );
+        CHECK( cache.protected_size() == 1 );
+        CHECK( cache.erase( 7 ) );
+        CHECK( to_vector( cache ) == std::vector<int>{30, 20} );
+
+        cache.put( 8, 80 );
+        CHECK( to_vector( cache ) == std::vector<int>{30, 80, 20} );
+    }
+}
+
+TEST_CASE( "SLRU without probation room" )
+{
+    SECTION( "everything protected" )
+    {
+        slru_cache<int, int> cache( 2, 2 );
+
+        cache.put( 1, 10 );
+        cache.put( 2, 20 );
+        cache.get( 1 );
+        cache.get( 2 );
+
+        // a new entry is kept, the protected tail goes
+        cache.put( 3, 30 );
+        CHECK( to_vector( cache ) == std::vector<int>{20, 30} );
+    }
+    SECTION( "nothing protected" )
+    {
+        slru_cache<int, int> cache( 2, 0 );
+
+        cache.put( 1, 10 );
+        cache.put( 2, 20 );
+        cache.get( 1 );
+        CHECK( cache.protected_size() == 0 );
+        CHECK( to_vector( cache ) == std::vector<int>{10, 20} );
+
+        cache.put( 3, 30 );
+        CHECK( to_vector( cache ) == std::vector<int>{30, 10} );
+    }
+    SECTION( "zero capacity" )
+    {
+        slru_cache<int, int> cache( 0 );
+
+        cache.put( 1, 10 );
+        CHECK( cache.size() == 0 );
+        CHECK( cache.begin() == cache.end() );
+    }
+}
+
+// A hot set hit between scans of cold keys: every scan flushes lru_cache,
+// while slru_cache keeps the hot set in the protected segment.
+TEST_CASE( "SLRU scan resistance" )
+{
+    const int cache_size = 100;
+    const int hot_size   = 50;
+    const int scan_size  = 200;
+    const int rounds     = 20;
+
+    slru_cache<int, int> slru( cache_size );
+    lru_cache<int, int>  lru( cache_size );
+
+    size_t slru_hits = 0;
+    size_t lru_hits  = 0;
+    size_t lookups   = 0;
+    int    cold      = hot_size;
+    for( int round = 0; round < rounds; round++ )
+    {
+        for( int pass = 0; pass < 2; pass++ )
+        {
+            for( int key = 0; key < hot_size; key++ )
+            {
+                ++lookups;
+                if( slru.get( key ) != slru.end() )
+                {
+                    ++slru_hits;
+                }
+                else
+                {
+                    slru.put( key, key );
+                }
+                if( lru.get( key ) != lru.end() )
+                {
+                    ++lru_hits;
+                }
+                else
+                {
+                    lru.put( key, key );
+                }
+            }
+        }
+        for( int i = 0; i < scan_size; i++, cold++ )
+        {
+            ++lookups;
+            slru.put( cold, cold );
+            lru.put( cold, cold );
+        }
+    }
+
+    for( int key = 0; key < hot_size; key++ )
+    {
+        CHECK( slru.contains( key ) );
+        CHECK_FALSE( lru.contains( key ) );
+    }
+    // a hit ratio higher by more than 10 points
+    CHECK( ( slru_hits - lru_hits ) * 10 > lookups );
+}
+
+TEST_CASE( "SLRU heterogeneous lookup" )
+{
+    slru_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "SLRU ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    slru_cache<int, TestType> cache( cache_len );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+    }
+    // a part of the entries is protected
+    for( size_t i = data_len - 10; i < data_len; i++ )
+    {
+        cache.get( i );
+    }
+    auto expected = to_vector( cache );
+
+    SECTION( "ctors" )
+    {
+        slru_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.protected_size() == 10 );
+
+        // the segments are rebuilt too
+        cache_new.put( -1, buff[0] );
+        cache.put( -1, buff[0] );
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+    }
+
+    SECTION( "assignment" )
+    {
+        slru_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        slru_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "slru_cache erase_if and clear" )
+{
+    slru_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+    for( int i = 0; i < 100; i += 3 )
+    {
+        cache.get( i );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK( cache.protected_size() == 17 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.protected_size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
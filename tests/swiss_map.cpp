@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <cachew/swiss_map.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "swiss_map base" )
+{
+    swiss_map<int, int> map;
+
+    CHECK( map.empty() );
+    CHECK( map.find( 1 ) == map.end() );
+    CHECK( map.begin() == map.end() );
+
+    CHECK( map.emplace( 1, 11 ).second );
+    CHECK( map.emplace( 2, 22 ).second );
+    CHECK_FALSE( map.emplace( 1, 111 ).second );
+
+    REQUIRE( map.size() == 2 );
+    REQUIRE( map.find( 1 ) != map.end() );
+    CHECK( map.find( 1 )->second == 11 );
+
+    CHECK( map.erase( 1 ) == 1 );
+    CHECK( map.erase( 1 ) == 0 );
+    CHECK( map.find( 1 ) == map.end() );
+    CHECK( map.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "swiss_map matches unordered_map", "", int,
+                    std::string ) // NOLINT
+{
+    const size_t data_len = 5000;
+
+    std::vector<TestType> keys;
+    gen_test_seq( data_len, keys );
+
+    swiss_map<TestType, size_t>          map;
+    std::unordered_map<TestType, size_t> expected;
+
+    // random inserts and erases to exercise tombstones and rehashing
+    std::mt19937                          gen( 42 );
+    std::uniform_int_distribution<size_t> dis( 0, data_len - 1 );
+    for( size_t i = 0; i < data_len * 20; ++i )
+    {
+        const auto &key = keys[dis( gen )];
+        if( i % 3 == 0 )
+        {
+            CHECK( map.erase( key ) == expected.erase( key ) );
+        }
+        else
+        {
+            CHECK( map.emplace( key, i ).second ==
+                   expected.emplace( key, i ).second );
+        }
+    }
+
+    REQUIRE( map.size() == expected.size() );
+    for( const auto &kv : expected )
+    {
+        auto it = map.find( kv.first );
+        REQUIRE( it != map.end() );
+        CHECK( it->second == kv.second );
+    }
+
+    size_t count = 0;
+    for( auto it = map.begin(); it != map.end(); ++it )
+    {
+        ++count;
+    }
+    CHECK( count == expected.size() );
+
+    SECTION( "copy" )
+    {
+        swiss_map<TestType, size_t> map_new( map ); // NOLINT
+
+        REQUIRE( map_new.size() == expected.size() );
+        for( const auto &kv : expected )
+        {
+            auto it = map_new.find( kv.first );
+            REQUIRE( it != map_new.end() );
+            CHECK( it->second == kv.second );
+        }
+    }
+
+    SECTION( "clear" )
+    {
+        map.clear();
+
+        CHECK( map.empty() );
+        CHECK( map.begin() == map.end() );
+        CHECK( map.find( keys[0] ) == map.end() );
+    }
+}
@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include <cachew/timing_wheel.hpp>
+
+using namespace cachew;
+
+TEST_CASE( "timing_wheel base" )
+{
+    timing_wheel<int> wheel( 100 );
+    std::vector<int>  fired;
+    auto              collect = [&fired]( int v ) { fired.push_back( v ); };
+
+    CHECK( wheel.empty() );
+
+    wheel.schedule( 110, 1 );
+    wheel.schedule( 105, 2 );
+    auto h = wheel.schedule( 107, 3 );
+    wheel.schedule( 50, 4 );
+    CHECK( wheel.size() == 4 );
+
+    wheel.cancel( h );
+    CHECK( wheel.size() == 3 );
+
+    // past deadlines fire on the next tick
+    wheel.advance( 101, collect );
+    CHECK( fired == std::vector<int>{ 4 } );
+
+    wheel.advance( 109, collect );
+    CHECK( fired == std::vector<int>{ 4, 2 } );
+
+    wheel.advance( 110, collect );
+    CHECK( fired == std::vector<int>{ 4, 2, 1 } );
+    CHECK( wheel.empty() );
+    CHECK( wheel.now() == 110 );
+
+    // an empty wheel jumps to the new time
+    wheel.advance( 1'000'000, collect );
+    CHECK( wheel.now() == 1'000'000 );
+}
+
+TEST_CASE( "timing_wheel matches the reference" )
+{
+    std::mt19937                                 gen( 42 );
+    std::uniform_int_distribution<std::uint64_t> delay( 0, 1 << 20 );
+    std::uniform_int_distribution<std::uint64_t> step( 1, 1 << 14 );
+
+    timing_wheel<int>                      wheel;
+    std::vector<timing_wheel<int>::handle> handles;
+    std::map<int, std::uint64_t>           deadlines;
+
+    for( int i = 0; i < 20'000; ++i )
+    {
+        std::uint64_t deadline = wheel.now() + delay( gen );
+        // some timers are far beyond the wheel range
+        if( i % 1000 == 0 )
+        {
+            deadline += std::uint64_t( 1 ) << 32;
+        }
+        handles.push_back( wheel.schedule( deadline, i ) );
+        deadlines[i] = deadline;
+    }
+    for( int i = 0; i < 20'000; i += 3 )
+    {
+        wheel.cancel( handles[i] );
+        deadlines.erase( i );
+    }
+
+    bool          mismatch = false;
+    std::uint64_t now      = 0;
+    while( !wheel.empty() )
+    {
+        now += step( gen ) * ( now > ( 1 << 21 ) ? 1 << 12 : 1 );
+        wheel.advance( now, [&]( int v ) {
+            auto it = deadlines.find( v );
+            mismatch |= it == deadlines.end() || it->second > now;
+            deadlines.erase( v );
+        } );
+        for( auto &d : deadlines )
+        {
+            mismatch |= d.second <= now;
+        }
+    }
+    CHECK_FALSE( mismatch );
+    CHECK( deadlines.empty() );
+}
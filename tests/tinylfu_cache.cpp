@@ -0,0 +1,272 @@
+#include "catch.hpp"
+
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lfu_cache.hpp>
+#include <cachew/lru_cache.hpp>
+#include <cachew/tinylfu_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "TinyLFU iterator" )
+{
+    tinylfu_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "TinyLFU cache size" )
+{
+    tinylfu_cache<int, int> cache( 500 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 500 );
+    CHECK( cache.window_capacity() == 5 );
+    CHECK( cache.protected_capacity() == 396 );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        cache.put( i, i );
+        cache.get( i );
+    }
+    CHECK( cache.size() == 500 );
+    CHECK( cache.window_size() == 5 );
+
+    tinylfu_cache<int, int> tiny( 1 );
+    tiny.put( 1, 10 );
+    tiny.put( 2, 20 );
+    CHECK( to_set( tiny ) == std::set<int>{20} );
+
+    tinylfu_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "TinyLFU admission" )
+{
+    tinylfu_cache<int, int> cache( 10 );
+
+    // the window holds one entry, the others go to probation while the main
+    // region has room
+    for( int i = 1; i <= 10; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    CHECK( to_vector( cache ) ==
+           std::vector<int>{90, 80, 70, 60, 50, 40, 30, 20, 10, 100} );
+
+    // a new key is not more frequent than the main victim
+    cache.put( 11, 110 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( cache.contains( 1 ) );
+
+    // hits promote to the protected segment
+    cache.get( 1 );
+    cache.get( 2 );
+    CHECK( cache.protected_size() == 2 );
+    CHECK( to_vector( cache ) ==
+           std::vector<int>{20, 10, 90, 80, 70, 60, 50, 40, 30, 110} );
+
+    cache.put( 12, 120 );
+    CHECK_FALSE( cache.contains( 11 ) );
+
+    // a key put often enough replaces the main victim
+    cache.put( 12, 121 );
+    cache.put( 12, 122 );
+    CHECK( cache.frequency( 12 ) > cache.frequency( 3 ) );
+    cache.put( 13, 130 );
+    CHECK_FALSE( cache.contains( 3 ) );
+    CHECK( to_vector( cache ) ==
+           std::vector<int>{20, 10, 122, 90, 80, 70, 60, 50, 40, 130} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 1 ) );
+        CHECK_FALSE( cache.erase( 1 ) );
+        CHECK( cache.erase( 13 ) );
+        CHECK( cache.protected_size() == 1 );
+        CHECK( cache.window_size() == 0 );
+
+        cache.put( 14, 140 );
+        cache.put( 15, 150 );
+        CHECK( to_vector( cache ) ==
+               std::vector<int>{20, 140, 122, 90, 80, 70, 60, 50, 40, 150} );
+    }
+}
+
+// Keys drawn from a Zipf distribution much wider than the cache, where LRU
+// keeps the many rarely seen keys at the cost of hot ones. Halfway through
+// the hot keys change, the frequencies lfu_cache learned keep the old ones.
+TEST_CASE( "TinyLFU hit ratio" )
+{
+    const size_t cache_size = 500;
+    const int    key_count  = 50'000;
+    const size_t lookups    = 200'000;
+
+    tinylfu_cache<int, int> tinylfu( cache_size );
+    lru_cache<int, int>     lru( cache_size );
+    lfu_cache<int, int>     lfu( cache_size );
+
+    auto access = []( auto &cache, int key ) {
+        if( cache.get( key ) != cache.end() )
+        {
+            return size_t( 1 );
+        }
+        cache.put( key, key );
+        return size_t( 0 );
+    };
+
+    std::mt19937      gen( 42 );
+    zipf_distribution zipf( key_count, 0.9 );
+
+    size_t tinylfu_hits = 0;
+    size_t lru_hits     = 0;
+    size_t lfu_hits     = 0;
+    for( size_t i = 0; i < lookups; i++ )
+    {
+        int key = static_cast<int>( zipf( gen ) );
+        if( i >= lookups / 2 )
+        {
+            key += key_count;
+        }
+        tinylfu_hits += access( tinylfu, key );
+        lru_hits += access( lru, key );
+        lfu_hits += access( lfu, key );
+    }
+
+    // more than 5 points over both
+    CHECK( ( tinylfu_hits - lru_hits ) * 20 > lookups );
+    CHECK( ( tinylfu_hits - lfu_hits ) * 20 > lookups );
+}
+
+TEST_CASE( "TinyLFU heterogeneous lookup" )
+{
+    tinylfu_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "TinyLFU ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    tinylfu_cache<int, TestType> cache( cache_len );
+
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+    }
+    for( size_t i = 0; i < cache_len; i += 3 )
+    {
+        cache.get( i );
+    }
+    auto expected = to_vector( cache );
+    REQUIRE( cache.protected_size() > 0 );
+
+    SECTION( "ctors" )
+    {
+        tinylfu_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.window_size() == cache.window_size() );
+        CHECK( cache_new.protected_size() == cache.protected_size() );
+
+        // the segments and the sketch are copied too
+        for( size_t i = 0; i < buff.size(); i += 2 )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+    }
+
+    SECTION( "assignment" )
+    {
+        tinylfu_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        tinylfu_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "tinylfu_cache erase_if and clear" )
+{
+    tinylfu_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.frequency( 11 ) == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}
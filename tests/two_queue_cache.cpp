@@ -0,0 +1,295 @@
+#include "catch.hpp"
+
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include <cachew/lru_cache.hpp>
+#include <cachew/two_queue_cache.hpp>
+
+#include "common.hpp"
+
+using namespace cachew;
+
+TEST_CASE( "2Q iterator" )
+{
+    two_queue_cache<int, int> cache( 5 );
+
+    cache.put( 1, 11 );
+    cache.put( 2, 22 );
+    cache.put( 3, 33 );
+
+    CHECK( cache.begin() != cache.end() );
+
+    auto it = cache.get( 42 );
+    CHECK( it == cache.end() );
+
+    it = cache.get( 1 );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 11 );
+
+    std::set<int> expected = {11, 22, 33};
+    CHECK( to_set( cache ) == expected );
+}
+
+TEST_CASE( "2Q cache size" )
+{
+    two_queue_cache<int, int> cache( 8 );
+
+    CHECK( cache.size() == 0 );
+    CHECK( cache.capacity() == 8 );
+    CHECK( cache.in_capacity() == 2 );
+    CHECK( cache.ghost_capacity() == 4 );
+
+    for( int i = 0; i < 20; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.size() == 8 );
+    CHECK( cache.in_size() == 8 );
+    CHECK( cache.ghost_size() == 4 );
+    CHECK( to_set( cache ) ==
+           std::set<int>{120, 130, 140, 150, 160, 170, 180, 190} );
+
+    two_queue_cache<int, int> empty( 0 );
+    empty.put( 1, 10 );
+    CHECK( empty.size() == 0 );
+}
+
+TEST_CASE( "2Q queues" )
+{
+    two_queue_cache<int, int> cache( 4, 1, 2 );
+
+    for( int i = 1; i <= 4; i++ )
+    {
+        cache.put( i, i * 10 );
+    }
+    // a hit in A1in does not move the entry
+    cache.get( 1 );
+    CHECK( to_vector( cache ) == std::vector<int>{40, 30, 20, 10} );
+
+    // the oldest A1in entry is pushed out to A1out
+    cache.put( 5, 50 );
+    CHECK( to_vector( cache ) == std::vector<int>{50, 40, 30, 20} );
+    CHECK( cache.ghost_size() == 1 );
+
+    // a key remembered by A1out goes to Am
+    cache.put( 1, 11 );
+    CHECK( to_vector( cache ) == std::vector<int>{11, 50, 40, 30} );
+    CHECK( cache.in_size() == 3 );
+    CHECK( cache.ghost_size() == 1 );
+
+    cache.put( 2, 22 );
+    CHECK( to_vector( cache ) == std::vector<int>{22, 11, 50, 40} );
+
+    // a hit in Am moves the entry to its front
+    cache.get( 1 );
+    CHECK( to_vector( cache ) == std::vector<int>{11, 22, 50, 40} );
+    cache.put( 2, 23 );
+    CHECK( to_vector( cache ) == std::vector<int>{23, 11, 50, 40} );
+
+    // A1in stays over its share, so the Am entries are kept
+    cache.put( 6, 60 );
+    cache.put( 7, 70 );
+    CHECK( to_vector( cache ) == std::vector<int>{23, 11, 70, 60} );
+
+    SECTION( "erase" )
+    {
+        CHECK( cache.erase( 1 ) );
+        CHECK_FALSE( cache.erase( 1 ) );
+        CHECK( cache.erase( 6 ) );
+        CHECK( to_vector( cache ) == std::vector<int>{23, 70} );
+        CHECK( cache.in_size() == 1 );
+
+        // erased keys are not remembered
+        cache.put( 8, 80 );
+        cache.put( 1, 12 );
+        CHECK( to_vector( cache ) == std::vector<int>{23, 12, 80, 70} );
+    }
+}
+
+TEST_CASE( "2Q Am eviction" )
+{
+    two_queue_cache<int, int> cache( 2, 1, 2 );
+
+    cache.put( 1, 10 );
+    cache.put( 2, 20 );
+    cache.put( 3, 30 );
+    cache.put( 1, 11 );
+    CHECK( to_vector( cache ) == std::vector<int>{11, 30} );
+
+    // A1in is within its share, so the last Am entry goes
+    cache.put( 2, 21 );
+    CHECK( to_vector( cache ) == std::vector<int>{21, 30} );
+    CHECK( cache.in_size() == 1 );
+}
+
+// A stable hot set between crawls of keys which are seen once: the hot keys
+// come back after more distinct keys than lru_cache holds, but within the
+// range remembered by A1out.
+TEST_CASE( "2Q one-hit wonders" )
+{
+    const int cache_size = 100;
+    const int hot_size   = 30;
+    const int crawl_size = 100;
+    const int rounds     = 20;
+
+    two_queue_cache<int, int> two_queue( cache_size );
+    lru_cache<int, int>       lru( cache_size );
+
+    size_t two_queue_hits = 0;
+    size_t lru_hits       = 0;
+    int    cold           = hot_size;
+    for( int round = 0; round < rounds; round++ )
+    {
+        for( int key = 0; key < hot_size; key++ )
+        {
+            if( two_queue.get( key ) != two_queue.end() )
+            {
+                ++two_queue_hits;
+            }
+            else
+            {
+                two_queue.put( key, key );
+            }
+            if( lru.get( key ) != lru.end() )
+            {
+                ++lru_hits;
+            }
+            else
+            {
+                lru.put( key, key );
+            }
+        }
+        for( int i = 0; i < crawl_size; i++, cold++ )
+        {
+            two_queue.put( cold, cold );
+            lru.put( cold, cold );
+        }
+    }
+
+    CHECK( lru_hits == 0 );
+    CHECK( two_queue_hits == hot_size * ( rounds - 2 ) );
+    for( int key = 0; key < hot_size; key++ )
+    {
+        CHECK( two_queue.contains( key ) );
+    }
+    CHECK( two_queue.ghost_size() == two_queue.ghost_capacity() );
+}
+
+TEST_CASE( "2Q heterogeneous lookup" )
+{
+    two_queue_cache<std::string, int, swiss_index> cache( 2 );
+
+    cache.put( "one", 1 );
+    cache.put( "two", 2 );
+
+    std::string_view key = "one";
+    auto             it  = cache.get( key );
+    REQUIRE( it != cache.end() );
+    CHECK( *it == 1 );
+    CHECK( cache.contains( "two" ) );
+    CHECK( cache.erase( std::string_view( "two" ) ) );
+    CHECK( cache.size() == 1 );
+}
+
+TEMPLATE_TEST_CASE( "2Q ctors and assignment", "", int, float,
+                    std::string ) // NOLINT
+{
+    const size_t data_len  = 1000;
+    const size_t cache_len = data_len / 2;
+
+    std::vector<TestType> buff;
+    gen_test_seq( data_len, buff );
+
+    two_queue_cache<int, TestType> cache( cache_len );
+
+    // the second round of keys seen in the first one goes to Am
+    for( size_t i = 0; i < buff.size(); i++ )
+    {
+        cache.put( i, buff[i] );
+    }
+    for( size_t i = data_len - cache_len - 10; i < data_len - cache_len; i++ )
+    {
+        cache.put( i, buff[i] );
+    }
+    auto expected = to_vector( cache );
+    REQUIRE( cache.in_size() == cache_len - 10 );
+
+    SECTION( "ctors" )
+    {
+        two_queue_cache<int, TestType> cache_new( cache ); // NOLINT
+
+        CHECK( to_vector( cache_new ) == expected );
+        CHECK( cache_new.in_size() == cache.in_size() );
+        CHECK( cache_new.ghost_size() == cache.ghost_size() );
+
+        // the queues are rebuilt too
+        for( size_t i = 0; i < 20; i++ )
+        {
+            cache_new.put( i, buff[0] );
+            cache.put( i, buff[0] );
+        }
+        CHECK( to_vector( cache_new ) == to_vector( cache ) );
+    }
+
+    SECTION( "assignment" )
+    {
+        two_queue_cache<int, TestType> cache_new( cache_len );
+
+        cache_new = cache;
+
+        CHECK( to_vector( cache_new ) == expected );
+    }
+
+    SECTION( "swap" )
+    {
+        two_queue_cache<int, TestType> cache_new( cache_len );
+
+        std::swap( cache_new, cache );
+
+        CHECK( cache.size() == 0 );
+        CHECK( cache.ghost_size() == 0 );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( to_vector( cache_new ) == expected );
+
+        cache_new.put( -1, buff[0] );
+        CHECK( cache_new.size() == cache_len );
+        CHECK( cache_new.contains( -1 ) );
+    }
+}
+
+TEST_CASE( "two_queue_cache erase_if and clear" )
+{
+    two_queue_cache<int, int> cache( 100 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        cache.put( i, i * 10 );
+    }
+
+    CHECK( cache.erase_if( []( int key, int ) { return key % 2 == 0; } ) ==
+           50 );
+    CHECK( cache.size() == 50 );
+    CHECK( cache.in_size() == 50 );
+    CHECK_FALSE( cache.contains( 10 ) );
+    CHECK( *cache.get( 11 ) == 110 );
+
+    for( int i = 100; i < 200; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.ghost_size() == 50 );
+
+    cache.clear();
+    CHECK( cache.size() == 0 );
+    CHECK( cache.ghost_size() == 0 );
+    CHECK( cache.begin() == cache.end() );
+
+    for( int i = 0; i < 150; ++i )
+    {
+        cache.put( i, i );
+    }
+    CHECK( cache.size() == 100 );
+}